@@ -12,6 +12,7 @@
 #include <cstdint>
 #include <iterator>
 #include <optional>
+#include <string_view>
 #include <string>
 #include <type_traits>
 #include <utility>
@@ -221,14 +222,31 @@ namespace cppdecl
     template <typename T>
     concept TemplateArgumentType = std::same_as<T, Type> || std::same_as<T, PseudoExpr>; // Sync with `TemplateArgument::Variant`.
 
+    namespace detail::TemplateArgs
+    {
+        // Parses `list.unparsed` into `list.args`. Returns false on failure.
+        // This is defined in `parse.h`. It's a template only to postpone the lookup, so that we don't need to include `parse.h` here.
+        template <typename L>
+        CPPDECL_CONSTEXPR bool Materialize(L &list);
+    }
+
     struct TemplateArgumentList
     {
         std::vector<TemplateArgument> args;
 
+        // If not empty, the arguments weren't parsed yet, and this is their original spelling including `<` and `>`. Then `args` is empty.
+        // This only happens when parsing with `ParseContext::lazy_template_args`. Call `MaterializeTemplateArgs()` from `parse.h` to parse them.
+        // The functions that don't modify the list (equality, hashing, `ToCode()`, etc) treat this as an opaque string,
+        //   except `Matches()`, which parses the arguments on the fly.
+        std::string unparsed;
+
         CPPDECL_EQUALITY_DECLARE(TemplateArgumentList)
 
+        [[nodiscard]] CPPDECL_CONSTEXPR bool IsLazy() const {return !unparsed.empty();}
+
         // Checks if this argument list matches `values...`, where each is either a `Type` or a `PseudoExpr`.
         // Both the size and each element must match exactly.
+        // If the list is lazy, this needs `parse.h` to be included, and parses a copy of it every time. Returns false if that fails.
         [[nodiscard]] CPPDECL_CONSTEXPR bool Matches(const TemplateArgumentType auto &... values) const;
 
         // Visit all instances of any of `C...` nested in this. `func` is `(auto &name) -> void`.
@@ -853,7 +871,58 @@ namespace cppdecl
             // No suffix is stored as an empty string. This also helps us work around the Clang quirk with default member initializers in the first member of a variant.
             std::variant<std::string, Suffix> suffix{};
 
+            // The decoded `value`, filled by the parser to make `ToInteger()` cheaper. Null if it doesn't fit into 64 bits, or if it wasn't set.
+            // This is only a cache, and the equality comparison ignores it. If you modify `value`, reset this or call `UpdateCachedValue()`.
+            std::optional<std::uint64_t> cached_value;
+
             CPPDECL_EQUALITY_DECLARE(Integer)
+
+            // Decodes `value` in `base`, ignoring the `'`s. Returns null on overflow, or if there are invalid characters.
+            template <std::unsigned_integral T = std::uint64_t>
+            [[nodiscard]] static constexpr std::optional<T> DecodeValue(Base base, std::string_view value)
+            {
+                bool (*validation_func)(char ch) = nullptr;
+                T base_num = 0;
+                switch (base)
+                {
+                    case Base::decimal: validation_func = IsDigit;      base_num = 10; break;
+                    case Base::binary:  validation_func = IsBinDigit;   base_num = 2; break;
+                    case Base::octal:   validation_func = IsOctalDigit; base_num = 8; break;
+                    case Base::hex:     validation_func = IsHexDigit;   base_num = 16; break;
+                }
+
+                T ret{};
+
+                for (char ch : value)
+                {
+                    if (ch == '\'')
+                        continue;
+
+                    if (!validation_func(ch))
+                        return {}; // Invalid character in the string.
+
+                    T digit;
+                    if (ch >= 'a')
+                        digit = T(ch - 'a' + 10);
+                    else if (ch >= 'A')
+                        digit = T(ch - 'A' + 10);
+                    else
+                        digit = T(ch - '0');
+
+                    T new_ret = ret * base_num;
+                    if (new_ret / base_num != ret)
+                        return {}; // Overflow!
+
+                    ret = new_ret + digit;
+                }
+
+                return ret;
+            }
+
+            constexpr void UpdateCachedValue()
+            {
+                cached_value = DecodeValue(base, value);
+            }
         };
         struct FloatingPoint
         {
@@ -907,42 +976,15 @@ namespace cppdecl
 
             const Integer &i = std::get<Integer>(var);
 
-            bool (*validation_func)(char ch) = nullptr;
-            T base = 0;
-            switch (i.base)
-            {
-                case Integer::Base::decimal: validation_func = IsDigit;      base = 10; break;
-                case Integer::Base::binary:  validation_func = IsBinDigit;   base = 2; break;
-                case Integer::Base::octal:   validation_func = IsOctalDigit; base = 8; break;
-                case Integer::Base::hex:     validation_func = IsHexDigit;   base = 16; break;
-            }
-
-            T ret{};
-
-            for (char ch : i.value)
+            // Use the value decoded by the parser, if any.
+            if (i.cached_value)
             {
-                if (ch == '\'')
-                    continue;
-
-                if (!validation_func(ch))
-                    return {}; // Invalid character in the string.
-
-                T digit;
-                if (ch >= 'a')
-                    digit = T(ch - 'a' + 10);
-                else if (ch >= 'A')
-                    digit = T(ch - 'A' + 10);
-                else
-                    digit = T(ch - '0');
-
-                T new_ret = ret * base;
-                if (new_ret / base != ret)
+                if (*i.cached_value > T(-1))
                     return {}; // Overflow!
-
-                ret = new_ret + digit;
+                return T(*i.cached_value);
             }
 
-            return ret;
+            return Integer::DecodeValue<T>(i.base, i.value);
         }
 
         // Visit all instances of any of `C...` nested in this. (None for this type.) `func` is `(auto &name) -> void`.
@@ -1104,6 +1146,43 @@ namespace cppdecl
 
     using MaybeAmbiguousDecl = MaybeAmbiguous<Decl>;
 
+    // A declaration of one or more entities sharing the same decl-specifier-seq, e.g. `int a, *b, c[3]`. See `ParseDeclList()`.
+    struct DeclList
+    {
+        // The decl-specifier-seq shared by all declarations, including the leading attributes.
+        SimpleType simple_type;
+
+        // The declarations, one per declarator.
+        // Their `.type.simple_type` is empty if it's the same as `simple_type` above, which is the case unless the declarator has its own
+        //   trailing attributes or a trailing return type. The ambiguous alternatives (if any) always store the complete declarations.
+        std::vector<MaybeAmbiguousDecl> decls;
+
+        CPPDECL_EQUALITY_DECLARE(DeclList)
+
+        // Returns the complete declaration number `i`, with the shared `simple_type` filled in.
+        [[nodiscard]] CPPDECL_CONSTEXPR MaybeAmbiguousDecl GetDecl(std::size_t i) const
+        {
+            assert(i < decls.size());
+            MaybeAmbiguousDecl ret = decls[i];
+            if (ret.type.simple_type.IsEmpty())
+                ret.type.simple_type = simple_type;
+            return ret;
+        }
+
+        // Returns true if any of the declarations is ambiguous. See `MaybeAmbiguous::IsAmbiguous()`.
+        [[nodiscard]] CPPDECL_CONSTEXPR bool IsAmbiguous() const
+        {
+            return std::any_of(decls.begin(), decls.end(), [](const MaybeAmbiguousDecl &decl){return decl.IsAmbiguous();});
+        }
+
+        // Visit all instances of any of `C...` nested in this. `func` is `(auto &name) -> void`.
+        template <VisitableComponentType ...C> [[nodiscard]] CPPDECL_CONSTEXPR bool VisitEachComponent(VisitFlags flags, auto &&func);
+        template <VisitableComponentType ...C> [[nodiscard]] CPPDECL_CONSTEXPR bool VisitEachComponent(VisitFlags flags, auto &&func) const
+        {
+            return const_cast<DeclList &>(*this).VisitEachComponent<C...>(flags, [&func](auto &comp) -> VisitResult {return func(std::as_const(comp));});
+        }
+    };
+
 
     // A template argument.
     struct TemplateArgument
@@ -1392,6 +1471,10 @@ namespace cppdecl
         // The first token here will typically be the attribute name.
         PseudoExpr expr{};
 
+        // If not empty, this attribute list was parsed with `ParseAttributeListFlags::keep_raw_text`, and this is its original spelling, e.g. `[[a, b]]`.
+        // Then `expr` is empty.
+        std::string raw_text{};
+
         CPPDECL_EQUALITY_DECLARE(Attribute)
 
         // Visit all instances of any of `C...` nested in this. `func` is `(auto &name) -> void`.
@@ -1434,6 +1517,12 @@ namespace cppdecl
 
     [[nodiscard]] CPPDECL_CONSTEXPR bool TemplateArgumentList::Matches(const TemplateArgumentType auto &... values) const
     {
+        if (IsLazy())
+        {
+            TemplateArgumentList copy = *this;
+            return detail::TemplateArgs::Materialize(copy) && copy.Matches(values...);
+        }
+
         std::size_t i = 0;
         return sizeof...(values) == args.size() && (args[i++].Matches(values) && ...);
     }
@@ -2051,7 +2140,13 @@ namespace cppdecl
     CPPDECL_EQUALITY_DEFINE(PunctuationToken)
 
     CPPDECL_EQUALITY_DEFINE(NumericLiteral::Integer::Suffix)
-    CPPDECL_EQUALITY_DEFINE(NumericLiteral::Integer)
+
+    CPPDECL_CONSTEXPR bool NumericLiteral::Integer::operator==(const Integer &other) const
+    {
+        // Ignoring `cached_value`.
+        return base == other.base && value == other.value && suffix == other.suffix;
+    }
+
     CPPDECL_EQUALITY_DEFINE(NumericLiteral::FloatingPoint)
     CPPDECL_EQUALITY_DEFINE(NumericLiteral)
 
@@ -2101,6 +2196,22 @@ namespace cppdecl
     template <typename T>
     CPPDECL_EQUALITY_DEFINE(MaybeAmbiguous<T>)
 
+    CPPDECL_EQUALITY_DEFINE(DeclList)
+
+    template <VisitableComponentType ...C>
+    CPPDECL_CONSTEXPR bool DeclList::VisitEachComponent(VisitFlags flags, auto &&func)
+    {
+        if (simple_type.VisitEachComponent<C...>(flags, func))
+            return true;
+        for (MaybeAmbiguousDecl &decl : decls)
+        {
+            if (decl.VisitEachComponent<C...>(flags, func))
+                return true;
+        }
+
+        return false;
+    }
+
     CPPDECL_EQUALITY_DEFINE(TemplateArgument)
 
     template <VisitableComponentType ...C>
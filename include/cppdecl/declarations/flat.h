@@ -0,0 +1,825 @@
+#pragma once
+
+#include "cppdecl/declarations/data.h"
+#include "cppdecl/declarations/to_string.h"
+#include "cppdecl/misc/enum_flags.h"
+#include "cppdecl/misc/overload.h"
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string_view>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// A flat, index-based encoding of `Type` and `Decl`, see `FlatType` and `FlatDecl`.
+
+namespace cppdecl
+{
+    // The node kinds of the flat encoding.
+    // For each kind we list what it stores in `FlatNode::data`, its strings, and its children, in order.
+    // Optional children/strings are only present if the respective flag in `data` says so.
+    enum class FlatNodeKind : std::uint8_t
+    {
+        // Children: `simple_type`, then `modifiers...`.
+        type,
+        // Data: [0] = `has_nested_ambiguities`, [1] = has `ambiguous_alternative`.
+        // Children: `type`, `qualified_name`, then the alternative `decl` (optional).
+        decl,
+        // Data: [0] = `quals`, [1] = `flags`, [2] = `prefix`.
+        // Children: `attribute`s, then the `qualified_name`.
+        simple_type,
+        // Data: [0] = `style`.
+        // Children: `pseudo_expr`.
+        attribute,
+        // Data: [0] = `force_global_scope`, [1] = `flags`.
+        // Children: `name_...` parts.
+        qualified_name,
+
+        // Those correspond to the alternatives of `UnqualifiedName::Variant`.
+        // Data: [0] = has template arguments. If set, the last child is a `template_argument_list`.
+        name_word, // Strings: the word.
+        name_overloaded_operator, // Strings: `token`.
+        name_conversion_operator, // Children: `target_type`.
+        name_user_defined_literal, // Data: [1] = `space_before_suffix`. Strings: `suffix`.
+        name_destructor, // Children: `simple_type`.
+        name_new_delete_operator, // Data: [1] = `kind`.
+        name_unspellable, // Strings: `name`.
+
+        // Children: each argument is a `type` or a `pseudo_expr`.
+        template_argument_list,
+        // Children: the tokens, each is a `simple_type`, `punctuation_token`, `integer_literal`, `floating_point_literal`,
+        //   `string_or_char_literal`, `pseudo_expr_list` or `template_argument_list`.
+        pseudo_expr,
+        // Strings: `value`.
+        punctuation_token,
+        // Data: [0] = `base`, [1] = has a custom suffix string, [2] = `signed_part | is_unsigned << 4`.
+        // Strings: `value`, then the custom suffix (optional).
+        integer_literal,
+        // Data: [0] = `base`, [1] = has `value_frac`, [2] = zero if the suffix is a custom string, or the `Suffix` enum plus one.
+        // Strings: `value_int`, `value_frac` (optional), `value_exp`, then the custom suffix (optional).
+        floating_point_literal,
+        // Data: [0] = `kind`, [1] = `type`.
+        // Strings: `value`, `literal_suffix`, `raw_string_delim`.
+        string_or_char_literal,
+        // Data: [0] = `kind`, [1] = `has_trailing_comma`.
+        // Children: `pseudo_expr` elements.
+        pseudo_expr_list,
+
+        // Those correspond to the alternatives of `TypeModifier::Variant`.
+        pointer, // Data: [0] = `quals`.
+        reference, // Data: [0] = `quals`, [1] = `kind`.
+        member_pointer, // Data: [0] = `quals`. Children: `qualified_name`.
+        array, // Children: `pseudo_expr`.
+        function, // Data: [0] = `cv_quals`, [1] = `ref_qual`, [2] = the bools, see `detail::Flat::FunctionBits`. Children: parameter `decl`s.
+    };
+
+    // A single node of a flat tree. This is trivially copyable.
+    struct FlatNode
+    {
+        FlatNodeKind kind{};
+        // Small enums and bools, the meaning depends on `kind`.
+        std::array<std::uint8_t, 3> data{};
+
+        // The children of a node are stored contiguously in `FlatTree::nodes`.
+        std::uint32_t first_child = 0;
+        std::uint32_t num_children = 0;
+
+        // Indices into `FlatTree::strings`.
+        std::uint32_t first_string = 0;
+        std::uint32_t num_strings = 0;
+
+        friend constexpr bool operator==(const FlatNode &, const FlatNode &) = default;
+    };
+
+    // A string of a flat tree, stored in `FlatTree::chars`.
+    struct FlatString
+    {
+        std::uint32_t offset = 0;
+        std::uint32_t size = 0;
+
+        friend constexpr bool operator==(const FlatString &, const FlatString &) = default;
+    };
+
+    class FlatTree;
+
+    namespace detail::Flat
+    {
+        struct Writer;
+
+        // The bits in `FlatNode::data[2]` of `FlatNodeKind::function`.
+        enum class FunctionBits : std::uint8_t
+        {
+            noexcept_ = 1 << 0,
+            uses_trailing_return_type = 1 << 1,
+            c_style_void_params = 1 << 2,
+            c_style_variadic = 1 << 3,
+            c_style_variadic_without_comma = 1 << 4,
+        };
+        CPPDECL_FLAG_OPERATORS(FunctionBits)
+    }
+
+    // A non-owning reference to a node in a `FlatTree`.
+    class FlatNodeRef
+    {
+        const FlatTree *tree = nullptr;
+        std::uint32_t index = 0;
+
+      public:
+        constexpr FlatNodeRef() {}
+        constexpr FlatNodeRef(const FlatTree &tree, std::uint32_t index) : tree(&tree), index(index) {}
+
+        [[nodiscard]] constexpr const FlatTree &Tree() const {return *tree;}
+        [[nodiscard]] constexpr std::uint32_t Index() const {return index;}
+
+        [[nodiscard]] CPPDECL_CONSTEXPR const FlatNode &Node() const;
+        [[nodiscard]] CPPDECL_CONSTEXPR FlatNodeKind Kind() const {return Node().kind;}
+        [[nodiscard]] CPPDECL_CONSTEXPR std::uint8_t Data(std::size_t i) const {return Node().data[i];}
+
+        [[nodiscard]] CPPDECL_CONSTEXPR std::size_t NumChildren() const {return Node().num_children;}
+        [[nodiscard]] CPPDECL_CONSTEXPR FlatNodeRef Child(std::size_t i) const
+        {
+            assert(i < NumChildren());
+            return {*tree, std::uint32_t(Node().first_child + i)};
+        }
+
+        [[nodiscard]] CPPDECL_CONSTEXPR std::size_t NumStrings() const {return Node().num_strings;}
+        [[nodiscard]] CPPDECL_CONSTEXPR std::string_view String(std::size_t i) const;
+
+        friend constexpr bool operator==(const FlatNodeRef &, const FlatNodeRef &) = default;
+    };
+
+    // A tree stored in three flat arrays: nodes, string references, and characters.
+    // Copying it is just copying the three arrays, and visiting every node is a linear walk over `nodes`.
+    // The root is always the first node.
+    // Each node refers to a contiguous range of children, so the layout is somewhat breadth-first, but all nodes of a subtree
+    //   are still placed after their parent.
+    // Don't construct this directly, use `FlatType` or `FlatDecl`.
+    class FlatTree
+    {
+      protected:
+        std::vector<FlatNode> nodes;
+        std::vector<FlatString> strings;
+        std::string chars;
+
+        friend FlatNodeRef;
+        friend struct detail::Flat::Writer;
+
+      public:
+        // The nodes are laid out deterministically, so this is equivalent to comparing the trees.
+        friend CPPDECL_CONSTEXPR bool operator==(const FlatTree &, const FlatTree &) = default;
+
+        [[nodiscard]] CPPDECL_CONSTEXPR bool IsEmpty() const {return nodes.empty();}
+
+        [[nodiscard]] CPPDECL_CONSTEXPR FlatNodeRef Root() const
+        {
+            assert(!IsEmpty());
+            return {*this, 0};
+        }
+
+        [[nodiscard]] CPPDECL_CONSTEXPR std::size_t NumNodes() const {return nodes.size();}
+        [[nodiscard]] CPPDECL_CONSTEXPR FlatNodeRef NodeAt(std::size_t i) const
+        {
+            assert(i < nodes.size());
+            return {*this, std::uint32_t(i)};
+        }
+
+        // Calls `func` for every node of kind `kind`. `func` is `(FlatNodeRef node) -> VisitResult`.
+        // Returns true if `func` returned `VisitResult::stop`. `VisitResult::no_recurse` isn't supported, it's treated as `recurse`.
+        // This is the analog of `VisitEachComponent()`, except that the nodes are visited in the storage order, which is not the pre-order.
+        template <typename F>
+        CPPDECL_CONSTEXPR bool VisitNodes(FlatNodeKind kind, F &&func) const
+        {
+            for (std::uint32_t i = 0; i < nodes.size(); i++)
+            {
+                if (nodes[i].kind == kind && func(FlatNodeRef(*this, i)) == VisitResult::stop)
+                    return true;
+            }
+            return false;
+        }
+
+        // Approximate memory usage in bytes, not counting the size of this object itself.
+        [[nodiscard]] CPPDECL_CONSTEXPR std::size_t MemoryUsage() const
+        {
+            return nodes.capacity() * sizeof(FlatNode) + strings.capacity() * sizeof(FlatString) + chars.capacity();
+        }
+    };
+
+    CPPDECL_CONSTEXPR const FlatNode &FlatNodeRef::Node() const
+    {
+        assert(tree && index < tree->nodes.size());
+        return tree->nodes[index];
+    }
+
+    CPPDECL_CONSTEXPR std::string_view FlatNodeRef::String(std::size_t i) const
+    {
+        assert(i < NumStrings());
+        const FlatString &str = tree->strings[Node().first_string + i];
+        return std::string_view(tree->chars).substr(str.offset, str.size);
+    }
+
+    namespace detail::Flat
+    {
+        // Converts the data structures from `data.h` to the flat form.
+        struct Writer
+        {
+            FlatTree &tree;
+
+            [[nodiscard]] CPPDECL_CONSTEXPR FlatNode &NodeAt(std::uint32_t index)
+            {
+                return tree.nodes[index];
+            }
+
+            // Creates `n` uninitialized children for the node at `index`.
+            // This invalidates the references to the nodes, so we refer to them by indices everywhere.
+            CPPDECL_CONSTEXPR std::uint32_t AddChildren(std::uint32_t index, std::size_t n)
+            {
+                assert(tree.nodes.size() < std::uint32_t(-1) - n && "The tree is too large.");
+                std::uint32_t first = std::uint32_t(tree.nodes.size());
+                tree.nodes.resize(tree.nodes.size() + n);
+                NodeAt(index).first_child = first;
+                NodeAt(index).num_children = std::uint32_t(n);
+                return first;
+            }
+
+            // Adds strings to the node at `index`. Must be called at most once per node.
+            CPPDECL_CONSTEXPR void AddStrings(std::uint32_t index, std::initializer_list<std::string_view> list)
+            {
+                NodeAt(index).first_string = std::uint32_t(tree.strings.size());
+                NodeAt(index).num_strings = std::uint32_t(list.size());
+                for (std::string_view str : list)
+                {
+                    assert(tree.chars.size() + str.size() < std::uint32_t(-1) && "The tree is too large.");
+                    tree.strings.push_back({std::uint32_t(tree.chars.size()), std::uint32_t(str.size())});
+                    tree.chars += str;
+                }
+            }
+
+            CPPDECL_CONSTEXPR void Write(std::uint32_t index, FlatNodeKind kind, std::array<std::uint8_t, 3> data = {})
+            {
+                NodeAt(index).kind = kind;
+                NodeAt(index).data = data;
+            }
+
+            template <typename E>
+            [[nodiscard]] static constexpr std::uint8_t Byte(E value)
+            {
+                return std::uint8_t(value);
+            }
+
+            CPPDECL_CONSTEXPR void Write(std::uint32_t index, const Type &type)
+            {
+                Write(index, FlatNodeKind::type);
+                std::uint32_t first = AddChildren(index, 1 + type.modifiers.size());
+                Write(first, type.simple_type);
+                for (std::size_t i = 0; i < type.modifiers.size(); i++)
+                    Write(std::uint32_t(first + 1 + i), type.modifiers[i]);
+            }
+
+            CPPDECL_CONSTEXPR void Write(std::uint32_t index, const Decl &decl)
+            {
+                Write(index, FlatNodeKind::decl);
+                std::uint32_t first = AddChildren(index, 2);
+                Write(first, decl.type);
+                Write(first + 1, decl.name);
+            }
+
+            CPPDECL_CONSTEXPR void Write(std::uint32_t index, const MaybeAmbiguousDecl &decl)
+            {
+                Write(index, FlatNodeKind::decl, {Byte(decl.has_nested_ambiguities), Byte(bool(decl.ambiguous_alternative))});
+                std::uint32_t first = AddChildren(index, 2 + bool(decl.ambiguous_alternative));
+                Write(first, decl.type);
+                Write(first + 1, decl.name);
+                if (decl.ambiguous_alternative)
+                    Write(first + 2, *decl.ambiguous_alternative);
+            }
+
+            CPPDECL_CONSTEXPR void Write(std::uint32_t index, const SimpleType &simple_type)
+            {
+                Write(index, FlatNodeKind::simple_type, {Byte(simple_type.quals), Byte(simple_type.flags), Byte(simple_type.prefix)});
+                std::uint32_t first = AddChildren(index, simple_type.attrs.attrs.size() + 1);
+                for (std::size_t i = 0; i < simple_type.attrs.attrs.size(); i++)
+                    Write(std::uint32_t(first + i), simple_type.attrs.attrs[i]);
+                Write(std::uint32_t(first + simple_type.attrs.attrs.size()), simple_type.name);
+            }
+
+            CPPDECL_CONSTEXPR void Write(std::uint32_t index, const Attribute &attr)
+            {
+                Write(index, FlatNodeKind::attribute, {Byte(attr.style)});
+                // See `ParseAttributeListFlags::keep_raw_text`.
+                if (!attr.raw_text.empty())
+                    AddStrings(index, {attr.raw_text});
+                Write(AddChildren(index, 1), attr.expr);
+            }
+
+            CPPDECL_CONSTEXPR void Write(std::uint32_t index, const QualifiedName &name)
+            {
+                Write(index, FlatNodeKind::qualified_name, {Byte(name.force_global_scope), Byte(name.flags)});
+                std::uint32_t first = AddChildren(index, name.parts.size());
+                for (std::size_t i = 0; i < name.parts.size(); i++)
+                    Write(std::uint32_t(first + i), name.parts[i]);
+            }
+
+            CPPDECL_CONSTEXPR void Write(std::uint32_t index, const UnqualifiedName &name)
+            {
+                const bool has_targs = bool(name.template_args);
+
+                // How many children we need before the template arguments.
+                std::size_t num_payload_children = std::holds_alternative<ConversionOperator>(name.var) || std::holds_alternative<DestructorName>(name.var);
+                std::uint32_t first = AddChildren(index, num_payload_children + has_targs);
+
+                std::visit(Overload{
+                    [&](const std::string &word)
+                    {
+                        Write(index, FlatNodeKind::name_word, {Byte(has_targs)});
+                        AddStrings(index, {word});
+                    },
+                    [&](const OverloadedOperator &op)
+                    {
+                        Write(index, FlatNodeKind::name_overloaded_operator, {Byte(has_targs)});
+                        AddStrings(index, {op.token});
+                    },
+                    [&](const ConversionOperator &op)
+                    {
+                        Write(index, FlatNodeKind::name_conversion_operator, {Byte(has_targs)});
+                        Write(first, op.target_type);
+                    },
+                    [&](const UserDefinedLiteral &udl)
+                    {
+                        Write(index, FlatNodeKind::name_user_defined_literal, {Byte(has_targs), Byte(udl.space_before_suffix)});
+                        AddStrings(index, {udl.suffix});
+                    },
+                    [&](const DestructorName &dtor)
+                    {
+                        Write(index, FlatNodeKind::name_destructor, {Byte(has_targs)});
+                        Write(first, dtor.simple_type);
+                    },
+                    [&](const NewDeleteOperator &op)
+                    {
+                        Write(index, FlatNodeKind::name_new_delete_operator, {Byte(has_targs), Byte(op.kind)});
+                    },
+                    [&](const UnspellableName &unspellable)
+                    {
+                        Write(index, FlatNodeKind::name_unspellable, {Byte(has_targs)});
+                        AddStrings(index, {unspellable.name});
+                    },
+                }, name.var);
+
+                if (has_targs)
+                    Write(std::uint32_t(first + num_payload_children), *name.template_args);
+            }
+
+            CPPDECL_CONSTEXPR void Write(std::uint32_t index, const TemplateArgumentList &list)
+            {
+                Write(index, FlatNodeKind::template_argument_list);
+                // A lazy list (see `ParseContext::lazy_template_args`) is stored as a single string without children.
+                if (list.IsLazy())
+                    AddStrings(index, {list.unparsed});
+                std::uint32_t first = AddChildren(index, list.args.size());
+                for (std::size_t i = 0; i < list.args.size(); i++)
+                    std::visit([&](const auto &elem){Write(std::uint32_t(first + i), elem);}, list.args[i].var);
+            }
+
+            CPPDECL_CONSTEXPR void Write(std::uint32_t index, const PseudoExpr &expr)
+            {
+                Write(index, FlatNodeKind::pseudo_expr);
+                std::uint32_t first = AddChildren(index, expr.tokens.size());
+                for (std::size_t i = 0; i < expr.tokens.size(); i++)
+                    std::visit([&](const auto &elem){Write(std::uint32_t(first + i), elem);}, expr.tokens[i]);
+            }
+
+            CPPDECL_CONSTEXPR void Write(std::uint32_t index, const PunctuationToken &token)
+            {
+                Write(index, FlatNodeKind::punctuation_token);
+                AddStrings(index, {token.value});
+            }
+
+            CPPDECL_CONSTEXPR void Write(std::uint32_t index, const NumericLiteral &lit)
+            {
+                std::visit(Overload{
+                    [&](const NumericLiteral::Integer &value)
+                    {
+                        if (auto suffix = std::get_if<NumericLiteral::Integer::Suffix>(&value.suffix))
+                        {
+                            Write(index, FlatNodeKind::integer_literal, {Byte(value.base), 0, std::uint8_t(Byte(suffix->signed_part) | suffix->is_unsigned << 4)});
+                            AddStrings(index, {value.value});
+                        }
+                        else
+                        {
+                            Write(index, FlatNodeKind::integer_literal, {Byte(value.base), 1, 0});
+                            AddStrings(index, {value.value, std::get<std::string>(value.suffix)});
+                        }
+                    },
+                    [&](const NumericLiteral::FloatingPoint &value)
+                    {
+                        auto suffix = std::get_if<NumericLiteral::FloatingPoint::Suffix>(&value.suffix);
+                        Write(index, FlatNodeKind::floating_point_literal, {Byte(value.base), Byte(bool(value.value_frac)), std::uint8_t(suffix ? Byte(*suffix) + 1 : 0)});
+
+                        // The optional strings are skipped entirely, which is why the number of strings varies.
+                        if (value.value_frac && !suffix)
+                            AddStrings(index, {value.value_int, *value.value_frac, value.value_exp, std::get<std::string>(value.suffix)});
+                        else if (value.value_frac)
+                            AddStrings(index, {value.value_int, *value.value_frac, value.value_exp});
+                        else if (!suffix)
+                            AddStrings(index, {value.value_int, value.value_exp, std::get<std::string>(value.suffix)});
+                        else
+                            AddStrings(index, {value.value_int, value.value_exp});
+                    },
+                }, lit.var);
+            }
+
+            CPPDECL_CONSTEXPR void Write(std::uint32_t index, const StringOrCharLiteral &lit)
+            {
+                Write(index, FlatNodeKind::string_or_char_literal, {Byte(lit.kind), Byte(lit.type)});
+                AddStrings(index, {lit.value, lit.literal_suffix, lit.raw_string_delim});
+            }
+
+            CPPDECL_CONSTEXPR void Write(std::uint32_t index, const PseudoExprList &list)
+            {
+                Write(index, FlatNodeKind::pseudo_expr_list, {Byte(list.kind), Byte(list.has_trailing_comma)});
+                std::uint32_t first = AddChildren(index, list.elems.size());
+                for (std::size_t i = 0; i < list.elems.size(); i++)
+                    Write(std::uint32_t(first + i), list.elems[i]);
+            }
+
+            CPPDECL_CONSTEXPR void Write(std::uint32_t index, const TypeModifier &mod)
+            {
+                std::visit(Overload{
+                    [&](const Pointer &ptr)
+                    {
+                        Write(index, FlatNodeKind::pointer, {Byte(ptr.quals)});
+                    },
+                    [&](const Reference &ref)
+                    {
+                        Write(index, FlatNodeKind::reference, {Byte(ref.quals), Byte(ref.kind)});
+                    },
+                    [&](const MemberPointer &memptr)
+                    {
+                        Write(index, FlatNodeKind::member_pointer, {Byte(memptr.quals)});
+                        Write(AddChildren(index, 1), memptr.base);
+                    },
+                    [&](const Array &array)
+                    {
+                        Write(index, FlatNodeKind::array);
+                        Write(AddChildren(index, 1), array.size);
+                    },
+                    [&](const Function &func)
+                    {
+                        FunctionBits bits =
+                            func.noexcept_ * FunctionBits::noexcept_ |
+                            func.uses_trailing_return_type * FunctionBits::uses_trailing_return_type |
+                            func.c_style_void_params * FunctionBits::c_style_void_params |
+                            func.c_style_variadic * FunctionBits::c_style_variadic |
+                            func.c_style_variadic_without_comma * FunctionBits::c_style_variadic_without_comma;
+                        Write(index, FlatNodeKind::function, {Byte(func.cv_quals), Byte(func.ref_qual), Byte(bits)});
+                        std::uint32_t first = AddChildren(index, func.params.size());
+                        for (std::size_t i = 0; i < func.params.size(); i++)
+                            Write(std::uint32_t(first + i), func.params[i]);
+                    },
+                }, mod.var);
+            }
+
+            // Writes the root node.
+            template <typename T>
+            CPPDECL_CONSTEXPR void WriteRoot(const T &value)
+            {
+                tree.nodes.clear();
+                tree.strings.clear();
+                tree.chars.clear();
+                tree.nodes.emplace_back();
+                Write(0, value);
+            }
+        };
+
+        // Converts the flat form back to the data structures from `data.h`.
+        // Here we read the children by index, and assert that the kinds match what we expect.
+        struct Reader
+        {
+            template <typename E>
+            [[nodiscard]] static constexpr E Enum(std::uint8_t value)
+            {
+                return E(value);
+            }
+
+            [[nodiscard]] static CPPDECL_CONSTEXPR Type ReadType(FlatNodeRef node)
+            {
+                assert(node.Kind() == FlatNodeKind::type);
+                Type ret;
+                ret.simple_type = ReadSimpleType(node.Child(0));
+                ret.modifiers.reserve(node.NumChildren() - 1);
+                for (std::size_t i = 1; i < node.NumChildren(); i++)
+                    ret.modifiers.push_back(ReadTypeModifier(node.Child(i)));
+                return ret;
+            }
+
+            [[nodiscard]] static CPPDECL_CONSTEXPR MaybeAmbiguousDecl ReadDecl(FlatNodeRef node)
+            {
+                assert(node.Kind() == FlatNodeKind::decl);
+                MaybeAmbiguousDecl ret;
+                ret.type = ReadType(node.Child(0));
+                ret.name = ReadQualifiedName(node.Child(1));
+                ret.has_nested_ambiguities = node.Data(0);
+                if (node.Data(1))
+                    ret.ambiguous_alternative = ReadDecl(node.Child(2));
+                return ret;
+            }
+
+            [[nodiscard]] static CPPDECL_CONSTEXPR SimpleType ReadSimpleType(FlatNodeRef node)
+            {
+                assert(node.Kind() == FlatNodeKind::simple_type);
+                SimpleType ret;
+                ret.quals = Enum<CvQualifiers>(node.Data(0));
+                ret.flags = Enum<SimpleTypeFlags>(node.Data(1));
+                ret.prefix = Enum<SimpleTypePrefix>(node.Data(2));
+                ret.attrs.attrs.reserve(node.NumChildren() - 1);
+                for (std::size_t i = 0; i + 1 < node.NumChildren(); i++)
+                    ret.attrs.attrs.push_back(ReadAttribute(node.Child(i)));
+                ret.name = ReadQualifiedName(node.Child(node.NumChildren() - 1));
+                return ret;
+            }
+
+            [[nodiscard]] static CPPDECL_CONSTEXPR Attribute ReadAttribute(FlatNodeRef node)
+            {
+                assert(node.Kind() == FlatNodeKind::attribute);
+                Attribute ret;
+                ret.style = Enum<Attribute::Style>(node.Data(0));
+                if (node.NumStrings() > 0)
+                    ret.raw_text = node.String(0);
+                ret.expr = ReadPseudoExpr(node.Child(0));
+                return ret;
+            }
+
+            [[nodiscard]] static CPPDECL_CONSTEXPR QualifiedName ReadQualifiedName(FlatNodeRef node)
+            {
+                assert(node.Kind() == FlatNodeKind::qualified_name);
+                QualifiedName ret;
+                ret.force_global_scope = node.Data(0);
+                ret.flags = Enum<QualifiedNameFlags>(node.Data(1));
+                ret.parts.reserve(node.NumChildren());
+                for (std::size_t i = 0; i < node.NumChildren(); i++)
+                    ret.parts.push_back(ReadUnqualifiedName(node.Child(i)));
+                return ret;
+            }
+
+            [[nodiscard]] static CPPDECL_CONSTEXPR UnqualifiedName ReadUnqualifiedName(FlatNodeRef node)
+            {
+                UnqualifiedName ret;
+                switch (node.Kind())
+                {
+                  case FlatNodeKind::name_word:
+                    ret.var = std::string(node.String(0));
+                    break;
+                  case FlatNodeKind::name_overloaded_operator:
+                    ret.var = OverloadedOperator{.token = std::string(node.String(0))};
+                    break;
+                  case FlatNodeKind::name_conversion_operator:
+                    ret.var = ConversionOperator{.target_type = ReadType(node.Child(0))};
+                    break;
+                  case FlatNodeKind::name_user_defined_literal:
+                    ret.var = UserDefinedLiteral{.suffix = std::string(node.String(0)), .space_before_suffix = bool(node.Data(1))};
+                    break;
+                  case FlatNodeKind::name_destructor:
+                    ret.var = DestructorName{.simple_type = ReadSimpleType(node.Child(0))};
+                    break;
+                  case FlatNodeKind::name_new_delete_operator:
+                    ret.var = NewDeleteOperator{.kind = Enum<NewDeleteOperator::Kind>(node.Data(1))};
+                    break;
+                  case FlatNodeKind::name_unspellable:
+                    ret.var = UnspellableName{.name = std::string(node.String(0))};
+                    break;
+                  default:
+                    assert(false && "Expected an unqualified name node.");
+                    break;
+                }
+
+                if (node.Data(0))
+                    ret.template_args = ReadTemplateArgumentList(node.Child(node.NumChildren() - 1));
+
+                return ret;
+            }
+
+            [[nodiscard]] static CPPDECL_CONSTEXPR TemplateArgumentList ReadTemplateArgumentList(FlatNodeRef node)
+            {
+                assert(node.Kind() == FlatNodeKind::template_argument_list);
+                TemplateArgumentList ret;
+                if (node.NumStrings() > 0)
+                    ret.unparsed = node.String(0);
+                ret.args.reserve(node.NumChildren());
+                for (std::size_t i = 0; i < node.NumChildren(); i++)
+                {
+                    FlatNodeRef child = node.Child(i);
+                    if (child.Kind() == FlatNodeKind::type)
+                        ret.args.push_back({ReadType(child)});
+                    else
+                        ret.args.push_back({ReadPseudoExpr(child)});
+                }
+                return ret;
+            }
+
+            [[nodiscard]] static CPPDECL_CONSTEXPR PseudoExpr ReadPseudoExpr(FlatNodeRef node)
+            {
+                assert(node.Kind() == FlatNodeKind::pseudo_expr);
+                PseudoExpr ret;
+                ret.tokens.reserve(node.NumChildren());
+                for (std::size_t i = 0; i < node.NumChildren(); i++)
+                {
+                    FlatNodeRef child = node.Child(i);
+                    switch (child.Kind())
+                    {
+                      case FlatNodeKind::simple_type:
+                        ret.tokens.push_back(ReadSimpleType(child));
+                        break;
+                      case FlatNodeKind::punctuation_token:
+                        ret.tokens.push_back(PunctuationToken{.value = std::string(child.String(0))});
+                        break;
+                      case FlatNodeKind::integer_literal:
+                      case FlatNodeKind::floating_point_literal:
+                        ret.tokens.push_back(ReadNumericLiteral(child));
+                        break;
+                      case FlatNodeKind::string_or_char_literal:
+                        ret.tokens.push_back(ReadStringOrCharLiteral(child));
+                        break;
+                      case FlatNodeKind::pseudo_expr_list:
+                        ret.tokens.push_back(ReadPseudoExprList(child));
+                        break;
+                      case FlatNodeKind::template_argument_list:
+                        ret.tokens.push_back(ReadTemplateArgumentList(child));
+                        break;
+                      default:
+                        assert(false && "Expected a token node.");
+                        break;
+                    }
+                }
+                return ret;
+            }
+
+            [[nodiscard]] static CPPDECL_CONSTEXPR NumericLiteral ReadNumericLiteral(FlatNodeRef node)
+            {
+                NumericLiteral ret;
+                if (node.Kind() == FlatNodeKind::integer_literal)
+                {
+                    NumericLiteral::Integer value;
+                    value.base = Enum<NumericLiteral::Integer::Base>(node.Data(0));
+                    value.value = node.String(0);
+                    if (node.Data(1))
+                        value.suffix = std::string(node.String(1));
+                    else
+                        value.suffix = NumericLiteral::Integer::Suffix{.signed_part = Enum<NumericLiteral::Integer::SignedSuffix>(node.Data(2) & 0xf), .is_unsigned = bool(node.Data(2) >> 4)};
+                    // The cached value isn't stored in the flat form, so decode it again.
+                    value.UpdateCachedValue();
+                    ret.var = std::move(value);
+                }
+                else
+                {
+                    assert(node.Kind() == FlatNodeKind::floating_point_literal);
+                    NumericLiteral::FloatingPoint value;
+                    value.base = Enum<NumericLiteral::FloatingPoint::Base>(node.Data(0));
+                    std::size_t i = 0;
+                    value.value_int = node.String(i++);
+                    if (node.Data(1))
+                        value.value_frac = std::string(node.String(i++));
+                    value.value_exp = node.String(i++);
+                    if (node.Data(2))
+                        value.suffix = Enum<NumericLiteral::FloatingPoint::Suffix>(std::uint8_t(node.Data(2) - 1));
+                    else
+                        value.suffix = std::string(node.String(i++));
+                    assert(i == node.NumStrings());
+                    ret.var = std::move(value);
+                }
+                return ret;
+            }
+
+            [[nodiscard]] static CPPDECL_CONSTEXPR StringOrCharLiteral ReadStringOrCharLiteral(FlatNodeRef node)
+            {
+                assert(node.Kind() == FlatNodeKind::string_or_char_literal);
+                StringOrCharLiteral ret;
+                ret.kind = Enum<StringOrCharLiteral::Kind>(node.Data(0));
+                ret.type = Enum<StringOrCharLiteral::Type>(node.Data(1));
+                ret.value = node.String(0);
+                ret.literal_suffix = node.String(1);
+                ret.raw_string_delim = node.String(2);
+                return ret;
+            }
+
+            [[nodiscard]] static CPPDECL_CONSTEXPR PseudoExprList ReadPseudoExprList(FlatNodeRef node)
+            {
+                assert(node.Kind() == FlatNodeKind::pseudo_expr_list);
+                PseudoExprList ret;
+                ret.kind = Enum<PseudoExprList::Kind>(node.Data(0));
+                ret.has_trailing_comma = node.Data(1);
+                ret.elems.reserve(node.NumChildren());
+                for (std::size_t i = 0; i < node.NumChildren(); i++)
+                    ret.elems.push_back(ReadPseudoExpr(node.Child(i)));
+                return ret;
+            }
+
+            [[nodiscard]] static CPPDECL_CONSTEXPR TypeModifier ReadTypeModifier(FlatNodeRef node)
+            {
+                TypeModifier ret;
+                switch (node.Kind())
+                {
+                  case FlatNodeKind::pointer:
+                    {
+                        Pointer ptr;
+                        ptr.quals = Enum<CvQualifiers>(node.Data(0));
+                        ret.var = ptr;
+                    }
+                    break;
+                  case FlatNodeKind::reference:
+                    {
+                        Reference ref;
+                        ref.quals = Enum<CvQualifiers>(node.Data(0));
+                        ref.kind = Enum<RefQualifier>(node.Data(1));
+                        ret.var = ref;
+                    }
+                    break;
+                  case FlatNodeKind::member_pointer:
+                    {
+                        MemberPointer memptr;
+                        memptr.quals = Enum<CvQualifiers>(node.Data(0));
+                        memptr.base = ReadQualifiedName(node.Child(0));
+                        ret.var = std::move(memptr);
+                    }
+                    break;
+                  case FlatNodeKind::array:
+                    ret.var = Array{.size = ReadPseudoExpr(node.Child(0))};
+                    break;
+                  case FlatNodeKind::function:
+                    {
+                        Function func;
+                        func.cv_quals = Enum<CvQualifiers>(node.Data(0));
+                        func.ref_qual = Enum<RefQualifier>(node.Data(1));
+                        FunctionBits bits = Enum<FunctionBits>(node.Data(2));
+                        func.noexcept_ = bool(bits & FunctionBits::noexcept_);
+                        func.uses_trailing_return_type = bool(bits & FunctionBits::uses_trailing_return_type);
+                        func.c_style_void_params = bool(bits & FunctionBits::c_style_void_params);
+                        func.c_style_variadic = bool(bits & FunctionBits::c_style_variadic);
+                        func.c_style_variadic_without_comma = bool(bits & FunctionBits::c_style_variadic_without_comma);
+                        func.params.reserve(node.NumChildren());
+                        for (std::size_t i = 0; i < node.NumChildren(); i++)
+                            func.params.push_back(ReadDecl(node.Child(i)));
+                        ret.var = std::move(func);
+                    }
+                    break;
+                  default:
+                    assert(false && "Expected a type modifier node.");
+                    break;
+                }
+                return ret;
+            }
+        };
+    }
+
+    // A flat encoding of a `Type`. See `FlatTree` for the details.
+    // This is lossless: `FlatType(type).ToType() == type` is always true.
+    class FlatType : public FlatTree
+    {
+      public:
+        CPPDECL_CONSTEXPR FlatType() {}
+        CPPDECL_CONSTEXPR explicit FlatType(const Type &type)
+        {
+            detail::Flat::Writer{*this}.WriteRoot(type);
+        }
+
+        [[nodiscard]] CPPDECL_CONSTEXPR Type ToType() const
+        {
+            if (IsEmpty())
+                return {};
+            return detail::Flat::Reader::ReadType(Root());
+        }
+    };
+
+    // A flat encoding of a `MaybeAmbiguousDecl` (or a `Decl`). See `FlatTree` for the details.
+    // This is lossless: `FlatDecl(decl).ToDecl() == decl` is always true.
+    class FlatDecl : public FlatTree
+    {
+      public:
+        CPPDECL_CONSTEXPR FlatDecl() {}
+        CPPDECL_CONSTEXPR explicit FlatDecl(const MaybeAmbiguousDecl &decl)
+        {
+            detail::Flat::Writer{*this}.WriteRoot(decl);
+        }
+
+        [[nodiscard]] CPPDECL_CONSTEXPR MaybeAmbiguousDecl ToDecl() const
+        {
+            if (IsEmpty())
+                return {};
+            return detail::Flat::Reader::ReadDecl(Root());
+        }
+    };
+
+    // Those convert back to the regular representation to do the printing. Spelling the declarators requires random access to the
+    //   modifiers anyway, so there wouldn't be much benefit in duplicating all of `to_string.h` here.
+    [[nodiscard]] CPPDECL_CONSTEXPR std::string ToCode(const FlatType &target, ToCodeFlags flags)
+    {
+        return ToCode(target.ToType(), flags);
+    }
+    [[nodiscard]] CPPDECL_CONSTEXPR std::string ToCode(const FlatDecl &target, ToCodeFlags flags)
+    {
+        return ToCode(target.ToDecl(), flags);
+    }
+}
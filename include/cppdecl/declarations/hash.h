@@ -0,0 +1,442 @@
+#pragma once
+
+#include "cppdecl/declarations/data.h"
+#include "cppdecl/misc/enum_flags.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <utility>
+#include <variant>
+
+// Structural hashing for the declaration nodes, see `Hash()`.
+
+namespace cppdecl
+{
+    enum class HashFlags
+    {
+        // Ignore the `const` on the top level of a type: on the first modifier if there are any, or on the `simple_type` otherwise.
+        // If `a.Equals(b, Type::EqualsFlags::as_if_target_is_const)` (or the same for `SimpleType` or the modifiers), then `a` and `b` hash the same with this flag.
+        ignore_top_level_const = 1 << 0,
+
+        // Ignore the template arguments of the last part of a qualified name (or of an unqualified name, when hashing one directly).
+        // When hashing a type, this applies to the name of its `simple_type`.
+        // If `a.Equals(b, QualifiedName::EqualsFlags::allow_missing_final_template_args_in_target)`
+        //   (or `UnqualifiedName::EqualsFlags::allow_missing_template_args_in_target`), then `a` and `b` hash the same with this flag.
+        // Note that there's no equivalent for `QualifiedName::EqualsFlags::allow_less_parts_in_target`, hash on the prefix yourself if you need it.
+        ignore_final_template_args = 1 << 1,
+    };
+    CPPDECL_FLAG_OPERATORS(HashFlags)
+
+    namespace detail::Hash
+    {
+        // Accumulates the hash. We use 64 bits regardless of the platform, and truncate at the end.
+        // This doesn't need to be cryptographically strong, only fast and with a reasonable distribution.
+        // The hashes are NOT stable across library versions, don't store them anywhere.
+        struct Hasher
+        {
+            std::uint64_t state = 0xcbf29ce484222325; // FNV-1a offset basis.
+
+            CPPDECL_CONSTEXPR void AddInt(std::uint64_t value)
+            {
+                // Same mixing as in `boost::hash_combine`, but 64-bit.
+                state ^= value + 0x9e3779b97f4a7c15 + (state << 12) + (state >> 4);
+            }
+
+            CPPDECL_CONSTEXPR void AddBool(bool value)
+            {
+                AddInt(value);
+            }
+
+            template <typename E> requires std::is_enum_v<E>
+            CPPDECL_CONSTEXPR void AddEnum(E value)
+            {
+                AddInt(std::uint64_t(value));
+            }
+
+            // FNV-1a, then mixed into the state. Also mixes in the length, so that adjacent strings don't run into each other.
+            CPPDECL_CONSTEXPR void AddString(std::string_view str)
+            {
+                std::uint64_t h = 0xcbf29ce484222325;
+                for (char ch : str)
+                {
+                    h ^= (unsigned char)ch;
+                    h *= 0x100000001b3;
+                }
+                AddInt(h);
+                AddInt(str.size());
+            }
+
+            template <typename ...P>
+            CPPDECL_CONSTEXPR void AddVariant(const std::variant<P...> &var)
+            {
+                AddInt(var.index());
+                std::visit([&](const auto &elem){Add(elem);}, var);
+            }
+
+            // The `Add()` overloads are members, so that they can call each other regardless of the order.
+            // The `flags` only apply to the object itself, and are selectively propagated to the members, the same way the `Equals()` functions propagate them.
+
+            CPPDECL_CONSTEXPR void Add(const std::string &str)
+            {
+                AddString(str);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const TemplateArgumentList &list)
+            {
+                if (list.IsLazy())
+                    AddString(list.unparsed);
+                AddInt(list.args.size());
+                for (const TemplateArgument &arg : list.args)
+                    Add(arg);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const QualifiedName &name, HashFlags flags = {})
+            {
+                // Not hashing `name.flags`, since `QualifiedName::Equals()` ignores them.
+                AddBool(name.force_global_scope);
+                AddInt(name.parts.size());
+                for (std::size_t i = 0; i < name.parts.size(); i++)
+                    Add(name.parts[i], i + 1 == name.parts.size() ? flags & HashFlags::ignore_final_template_args : HashFlags{});
+            }
+
+            CPPDECL_CONSTEXPR void Add(const AttributeList &list)
+            {
+                AddInt(list.attrs.size());
+                for (const Attribute &attr : list.attrs)
+                    Add(attr);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const SimpleType &simple_type, HashFlags flags = {})
+            {
+                CvQualifiers quals = simple_type.quals;
+                if (bool(flags & HashFlags::ignore_top_level_const))
+                    quals &= ~CvQualifiers::const_;
+
+                Add(simple_type.attrs);
+                AddEnum(quals);
+                AddEnum(simple_type.flags);
+                AddEnum(simple_type.prefix);
+                Add(simple_type.name, flags);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const Type &type, HashFlags flags = {})
+            {
+                AddInt(type.modifiers.size());
+                for (std::size_t i = 0; i < type.modifiers.size(); i++)
+                    Add(type.modifiers[i], i == 0 ? flags & HashFlags::ignore_top_level_const : HashFlags{});
+
+                // Like in `Type::Equals()`, the constness only matters on the first modifier. If there are no modifiers, it applies to the `simple_type` instead.
+                Add(type.simple_type, type.modifiers.empty() ? flags : flags & ~HashFlags::ignore_top_level_const);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const OverloadedOperator &op)
+            {
+                AddString(op.token);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const ConversionOperator &op)
+            {
+                Add(op.target_type);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const UserDefinedLiteral &udl)
+            {
+                AddString(udl.suffix);
+                AddBool(udl.space_before_suffix);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const DestructorName &dtor)
+            {
+                Add(dtor.simple_type);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const NewDeleteOperator &op)
+            {
+                AddEnum(op.kind);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const UnspellableName &name)
+            {
+                AddString(name.name);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const UnqualifiedName &name, HashFlags flags = {})
+            {
+                AddVariant(name.var);
+
+                // If the arguments are ignored, we must ignore their presence too, since the target is allowed to have none.
+                if (!bool(flags & HashFlags::ignore_final_template_args))
+                {
+                    AddBool(bool(name.template_args));
+                    if (name.template_args)
+                        Add(*name.template_args);
+                }
+            }
+
+            CPPDECL_CONSTEXPR void Add(const PunctuationToken &token)
+            {
+                AddString(token.value);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const NumericLiteral::Integer::Suffix &suffix)
+            {
+                AddEnum(suffix.signed_part);
+                AddBool(suffix.is_unsigned);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const NumericLiteral::Integer &value)
+            {
+                AddEnum(value.base);
+                AddString(value.value);
+                AddVariant(value.suffix);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const NumericLiteral::FloatingPoint::Suffix &suffix)
+            {
+                AddEnum(suffix);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const NumericLiteral::FloatingPoint &value)
+            {
+                AddEnum(value.base);
+                AddString(value.value_int);
+                AddBool(bool(value.value_frac));
+                if (value.value_frac)
+                    AddString(*value.value_frac);
+                AddString(value.value_exp);
+                AddVariant(value.suffix);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const NumericLiteral &lit)
+            {
+                AddVariant(lit.var);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const StringOrCharLiteral &lit)
+            {
+                AddEnum(lit.kind);
+                AddEnum(lit.type);
+                AddString(lit.value);
+                AddString(lit.literal_suffix);
+                AddString(lit.raw_string_delim);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const PseudoExprList &list)
+            {
+                AddEnum(list.kind);
+                AddInt(list.elems.size());
+                for (const PseudoExpr &elem : list.elems)
+                    Add(elem);
+                AddBool(list.has_trailing_comma);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const PseudoExpr &expr)
+            {
+                AddInt(expr.tokens.size());
+                for (const PseudoExpr::Token &token : expr.tokens)
+                    AddVariant(token);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const Decl &decl, HashFlags flags = {})
+            {
+                Add(decl.type, flags);
+                Add(decl.name);
+            }
+
+            template <typename T>
+            CPPDECL_CONSTEXPR void Add(const MaybeAmbiguous<T> &value, HashFlags flags = {})
+            {
+                Add(static_cast<const T &>(value), flags);
+                AddBool(value.has_nested_ambiguities);
+                AddBool(bool(value.ambiguous_alternative));
+                if (value.ambiguous_alternative)
+                    Add(*value.ambiguous_alternative, flags);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const TemplateArgument &arg)
+            {
+                AddVariant(arg.var);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const QualifiedModifier &mod, HashFlags flags)
+            {
+                CvQualifiers quals = mod.quals;
+                if (bool(flags & HashFlags::ignore_top_level_const))
+                    quals &= ~CvQualifiers::const_;
+                AddEnum(quals);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const Pointer &ptr, HashFlags flags = {})
+            {
+                Add(static_cast<const QualifiedModifier &>(ptr), flags);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const Reference &ref, HashFlags flags = {})
+            {
+                Add(static_cast<const QualifiedModifier &>(ref), flags);
+                AddEnum(ref.kind);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const MemberPointer &memptr, HashFlags flags = {})
+            {
+                Add(static_cast<const QualifiedModifier &>(memptr), flags);
+                Add(memptr.base);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const Array &array, HashFlags flags = {})
+            {
+                (void)flags; // Arrays can't be cv-qualified.
+                Add(array.size);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const Function &func, HashFlags flags = {})
+            {
+                (void)flags; // Functions can't be cv-qualified (`cv_quals` are for `this`, and they aren't affected by `as_if_target_is_const`).
+                AddInt(func.params.size());
+                for (const MaybeAmbiguousDecl &param : func.params)
+                    Add(param);
+                AddEnum(func.cv_quals);
+                AddEnum(func.ref_qual);
+                AddBool(func.noexcept_);
+                AddBool(func.uses_trailing_return_type);
+                AddBool(func.c_style_void_params);
+                AddBool(func.c_style_variadic);
+                AddBool(func.c_style_variadic_without_comma);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const TypeModifier &mod, HashFlags flags = {})
+            {
+                AddInt(mod.var.index());
+                std::visit([&](const auto &elem){Add(elem, flags);}, mod.var);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const Attribute &attr)
+            {
+                AddEnum(attr.style);
+                if (!attr.raw_text.empty())
+                    AddString(attr.raw_text);
+                Add(attr.expr);
+            }
+
+            [[nodiscard]] CPPDECL_CONSTEXPR std::size_t Finish() const
+            {
+                return std::size_t(state);
+            }
+        };
+
+        template <typename T>
+        concept Hashable = requires(Hasher &hasher, const T &value){hasher.Add(value);};
+
+        template <typename T>
+        concept HashableWithFlags = requires(Hasher &hasher, const T &value, HashFlags flags){hasher.Add(value, flags);};
+    }
+
+    // Computes a structural hash of any of the nodes from `data.h`.
+    // Equal objects always hash the same. See `HashFlags` for how to make the hash agree with the relaxed `Equals()` comparisons.
+    // The result is not stable across library versions or platforms, don't serialize it.
+    template <detail::Hash::Hashable T>
+    [[nodiscard]] CPPDECL_CONSTEXPR std::size_t Hash(const T &value)
+    {
+        detail::Hash::Hasher hasher;
+        hasher.Add(value);
+        return hasher.Finish();
+    }
+    // This version accepts flags. Not all types accept them, only those that can be compared with `Equals()` (and the things containing those).
+    template <detail::Hash::HashableWithFlags T>
+    [[nodiscard]] CPPDECL_CONSTEXPR std::size_t Hash(const T &value, HashFlags flags)
+    {
+        detail::Hash::Hasher hasher;
+        hasher.Add(value, flags);
+        return hasher.Finish();
+    }
+
+    // A hasher for the containers, when you need non-default `HashFlags`.
+    // E.g. `std::unordered_set<Type, NodeHasher<HashFlags::ignore_top_level_const>, YourEqualityComparator>`.
+    template <HashFlags Flags = HashFlags{}>
+    struct NodeHasher
+    {
+        template <detail::Hash::Hashable T>
+        [[nodiscard]] CPPDECL_CONSTEXPR std::size_t operator()(const T &value) const
+        {
+            if constexpr (Flags == HashFlags{})
+                return Hash(value);
+            else
+                return Hash(value, Flags);
+        }
+    };
+
+    // Stores a node along with its precomputed hash.
+    // Use this as a key in hash containers if the keys are looked up often, or if they are large.
+    // The stored value is immutable, since modifying it would invalidate the hash.
+    template <detail::Hash::Hashable T>
+    class HashedNode
+    {
+        T value;
+        std::size_t hash = 0;
+
+      public:
+        CPPDECL_CONSTEXPR HashedNode() : hash(cppdecl::Hash(value)) {}
+        CPPDECL_CONSTEXPR HashedNode(T new_value) : value(std::move(new_value)), hash(cppdecl::Hash(value)) {}
+
+        [[nodiscard]] CPPDECL_CONSTEXPR const T &Value() const {return value;}
+        [[nodiscard]] CPPDECL_CONSTEXPR const T &operator*() const {return value;}
+        [[nodiscard]] CPPDECL_CONSTEXPR const T *operator->() const {return &value;}
+
+        [[nodiscard]] CPPDECL_CONSTEXPR std::size_t Hash() const {return hash;}
+
+        // Compares the hashes first, so mismatches are usually cheap.
+        friend CPPDECL_CONSTEXPR bool operator==(const HashedNode &a, const HashedNode &b)
+        {
+            return a.hash == b.hash && a.value == b.value;
+        }
+    };
+}
+
+#define CPPDECL_DETAIL_STD_HASH(...) \
+    template <> struct std::hash<__VA_ARGS__> \
+    { \
+        [[nodiscard]] CPPDECL_CONSTEXPR std::size_t operator()(const __VA_ARGS__ &value) const {return cppdecl::Hash(value);} \
+    };
+
+CPPDECL_DETAIL_STD_HASH(cppdecl::TemplateArgumentList)
+CPPDECL_DETAIL_STD_HASH(cppdecl::QualifiedName)
+CPPDECL_DETAIL_STD_HASH(cppdecl::AttributeList)
+CPPDECL_DETAIL_STD_HASH(cppdecl::SimpleType)
+CPPDECL_DETAIL_STD_HASH(cppdecl::Type)
+CPPDECL_DETAIL_STD_HASH(cppdecl::OverloadedOperator)
+CPPDECL_DETAIL_STD_HASH(cppdecl::ConversionOperator)
+CPPDECL_DETAIL_STD_HASH(cppdecl::UserDefinedLiteral)
+CPPDECL_DETAIL_STD_HASH(cppdecl::DestructorName)
+CPPDECL_DETAIL_STD_HASH(cppdecl::NewDeleteOperator)
+CPPDECL_DETAIL_STD_HASH(cppdecl::UnspellableName)
+CPPDECL_DETAIL_STD_HASH(cppdecl::UnqualifiedName)
+CPPDECL_DETAIL_STD_HASH(cppdecl::PunctuationToken)
+CPPDECL_DETAIL_STD_HASH(cppdecl::NumericLiteral)
+CPPDECL_DETAIL_STD_HASH(cppdecl::StringOrCharLiteral)
+CPPDECL_DETAIL_STD_HASH(cppdecl::PseudoExprList)
+CPPDECL_DETAIL_STD_HASH(cppdecl::PseudoExpr)
+CPPDECL_DETAIL_STD_HASH(cppdecl::Decl)
+CPPDECL_DETAIL_STD_HASH(cppdecl::TemplateArgument)
+CPPDECL_DETAIL_STD_HASH(cppdecl::Pointer)
+CPPDECL_DETAIL_STD_HASH(cppdecl::Reference)
+CPPDECL_DETAIL_STD_HASH(cppdecl::MemberPointer)
+CPPDECL_DETAIL_STD_HASH(cppdecl::Array)
+CPPDECL_DETAIL_STD_HASH(cppdecl::Function)
+CPPDECL_DETAIL_STD_HASH(cppdecl::TypeModifier)
+CPPDECL_DETAIL_STD_HASH(cppdecl::Attribute)
+
+#undef CPPDECL_DETAIL_STD_HASH
+
+template <typename T>
+struct std::hash<cppdecl::MaybeAmbiguous<T>>
+{
+    [[nodiscard]] CPPDECL_CONSTEXPR std::size_t operator()(const cppdecl::MaybeAmbiguous<T> &value) const {return cppdecl::Hash(value);}
+};
+
+template <typename T>
+struct std::hash<cppdecl::HashedNode<T>>
+{
+    [[nodiscard]] CPPDECL_CONSTEXPR std::size_t operator()(const cppdecl::HashedNode<T> &value) const {return value.Hash();}
+};
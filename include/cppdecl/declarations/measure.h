@@ -0,0 +1,205 @@
+#pragma once
+
+#include "cppdecl/declarations/data.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <variant>
+
+// Measuring the size of the declaration nodes, see `Measure()`.
+
+namespace cppdecl
+{
+    // The result of `Measure()`.
+    struct Measurement
+    {
+        // The total number of nodes. We count types, template argument lists, pseudo-expressions and their tokens, parts of qualified names, and type modifiers.
+        // Those are the same things that `ParseLimits::max_nodes` counts.
+        std::size_t num_nodes = 0;
+
+        // The maximum nesting depth, in the same units as `ParseLimits::max_depth`.
+        // The types, template argument lists and pseudo-expressions increase the depth by one. E.g. `std::vector<int>` has depth 3.
+        std::size_t depth = 0;
+
+        // The total number of ambiguous alternatives (in `MaybeAmbiguous<T>::ambiguous_alternative`) at all levels.
+        // Zero if the thing isn't ambiguous.
+        std::size_t num_alternatives = 0;
+    };
+
+    namespace detail::Measure
+    {
+        struct Measurer
+        {
+            Measurement result;
+
+            std::size_t cur_depth = 0;
+
+            // Call this when entering a node that increases the depth, and `Leave()` when done with it.
+            CPPDECL_CONSTEXPR void Enter()
+            {
+                cur_depth++;
+                result.depth = std::max(result.depth, cur_depth);
+                result.num_nodes++;
+            }
+
+            CPPDECL_CONSTEXPR void Leave()
+            {
+                cur_depth--;
+            }
+
+            template <typename ...P>
+            CPPDECL_CONSTEXPR void AddVariant(const std::variant<P...> &var)
+            {
+                std::visit([&](const auto &elem){Add(elem);}, var);
+            }
+
+            // The `Add()` overloads are members, so that they can call each other regardless of the order.
+
+            // Those have no nested nodes.
+            CPPDECL_CONSTEXPR void Add(const std::string &) {}
+            CPPDECL_CONSTEXPR void Add(const OverloadedOperator &) {}
+            CPPDECL_CONSTEXPR void Add(const UserDefinedLiteral &) {}
+            CPPDECL_CONSTEXPR void Add(const NewDeleteOperator &) {}
+            CPPDECL_CONSTEXPR void Add(const UnspellableName &) {}
+            CPPDECL_CONSTEXPR void Add(const PunctuationToken &) {}
+            CPPDECL_CONSTEXPR void Add(const NumericLiteral &) {}
+            CPPDECL_CONSTEXPR void Add(const StringOrCharLiteral &) {}
+
+            CPPDECL_CONSTEXPR void Add(const TemplateArgumentList &list)
+            {
+                // Note that the lazy lists (see `ParseContext::lazy_template_args`) have no `args`, so they count as a single node.
+                Enter();
+                for (const TemplateArgument &arg : list.args)
+                    Add(arg);
+                Leave();
+            }
+
+            CPPDECL_CONSTEXPR void Add(const QualifiedName &name)
+            {
+                for (const UnqualifiedName &part : name.parts)
+                    Add(part);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const AttributeList &list)
+            {
+                for (const Attribute &attr : list.attrs)
+                    Add(attr);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const SimpleType &simple_type)
+            {
+                Add(simple_type.attrs);
+                Add(simple_type.name);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const Type &type)
+            {
+                Enter();
+                for (const TypeModifier &mod : type.modifiers)
+                    Add(mod);
+                Add(type.simple_type);
+                Leave();
+            }
+
+            CPPDECL_CONSTEXPR void Add(const ConversionOperator &op)
+            {
+                Add(op.target_type);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const DestructorName &dtor)
+            {
+                Add(dtor.simple_type);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const UnqualifiedName &name)
+            {
+                result.num_nodes++;
+                AddVariant(name.var);
+                if (name.template_args)
+                    Add(*name.template_args);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const PseudoExprList &list)
+            {
+                for (const PseudoExpr &elem : list.elems)
+                    Add(elem);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const PseudoExpr &expr)
+            {
+                Enter();
+                result.num_nodes += expr.tokens.size();
+                for (const PseudoExpr::Token &token : expr.tokens)
+                    AddVariant(token);
+                Leave();
+            }
+
+            CPPDECL_CONSTEXPR void Add(const Decl &decl)
+            {
+                Add(decl.type);
+                Add(decl.name);
+            }
+
+            template <typename T>
+            CPPDECL_CONSTEXPR void Add(const MaybeAmbiguous<T> &value)
+            {
+                Add(static_cast<const T &>(value));
+                if (value.ambiguous_alternative)
+                {
+                    result.num_alternatives++;
+                    Add(*value.ambiguous_alternative);
+                }
+            }
+
+            CPPDECL_CONSTEXPR void Add(const TemplateArgument &arg)
+            {
+                AddVariant(arg.var);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const Pointer &) {}
+            CPPDECL_CONSTEXPR void Add(const Reference &) {}
+
+            CPPDECL_CONSTEXPR void Add(const MemberPointer &memptr)
+            {
+                Add(memptr.base);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const Array &array)
+            {
+                Add(array.size);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const Function &func)
+            {
+                for (const MaybeAmbiguousDecl &param : func.params)
+                    Add(param);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const TypeModifier &mod)
+            {
+                result.num_nodes++;
+                AddVariant(mod.var);
+            }
+
+            CPPDECL_CONSTEXPR void Add(const Attribute &attr)
+            {
+                Add(attr.expr);
+            }
+        };
+
+        template <typename T>
+        concept Measurable = requires(Measurer &measurer, const T &value){measurer.Add(value);};
+    }
+
+    // Measures any of the nodes from `data.h`: counts the nodes, the nesting depth, and the ambiguous alternatives.
+    // This is a single pass over the nodes without any allocations, so it's cheap enough to call on every parsed type,
+    //   e.g. to enforce the same budgets as `ParseLimits` on the types that didn't come from the parser.
+    template <detail::Measure::Measurable T>
+    [[nodiscard]] CPPDECL_CONSTEXPR Measurement Measure(const T &value)
+    {
+        detail::Measure::Measurer measurer;
+        measurer.Add(value);
+        return measurer.result;
+    }
+}
@@ -1,18 +1,25 @@
 #pragma once
 
 #include "cppdecl/declarations/data.h"
+#include "cppdecl/declarations/measure.h"
 #include "cppdecl/misc/platform.h"
 #include "cppdecl/misc/string_helpers.h"
 
 #include <algorithm>
+#include <array>
+#include <cstddef>
 #include <iterator>
+#include <optional>
+#include <string_view>
 #include <type_traits>
 #include <utility>
 #include <variant>
+#include <vector>
 
 // Those functions parse various language constructs. There's a lot here, but you mainly want two functions:
 // * `ParseType()` to parse types.
 // * `ParseDecl()` to parse types or declarations (this is a superset of `ParseType` that allows names).
+// * `ParseDeclList()` to parse declarations of several entities at once, such as `int a, *b`.
 // * `ParseQualifiedName()` to parse names (this is mostly a subset of `ParseType`, e.g. it accepts `std::vector<int>` but not `std::vector<int> *`).
 // In any case, the return value is a `std::variant` of either the result or a parsing error.
 // The input `std::string_view` has the parsed prefix of it removed. On failure, the new start points to the error.
@@ -26,9 +33,464 @@ namespace cppdecl
         const char *message = nullptr;
     };
 
+    // Limits for parsing untrusted input. Exceeding any of them makes the parsing fail with a `ParseError`.
+    // Zero means no limit, which is the default.
+    // Pass those via `ParseContext` to the overloads of the parsing functions that accept it.
+    struct ParseLimits
+    {
+        // How deeply the types, template argument lists and expressions can nest.
+        // E.g. `std::vector<int>` has depth 3: the type, its template argument list, and the `int` in it.
+        // This is also the maximum recursion depth of the parser, roughly. See `Measure()` for measuring the existing nodes in the same units.
+        std::size_t max_depth = 0;
+
+        // How many nodes the parser can create in total. This counts the same things as `Measure()`, but also counts the nodes that were discarded
+        //   when backtracking, and counts again the nodes copied from the remembered results of the nested declarations (see `detail::Parse::DeclMemo`).
+        // So this bounds both the work done and the size of the result, roughly.
+        std::size_t max_nodes = 0;
+
+        // How many extra interpretations the parser can try in total, in all declarations of a single parse (including the nested ones, such as function parameters).
+        // `ParseDecl()` tries an extra one for each `(` that could start a function parameter list (plus one for an empty return type).
+        // Reusing the remembered result of a nested declaration counts its ambiguous alternatives again, the same way as `Measure()` counts them.
+        std::size_t max_alternatives = 0;
+
+        // How many arguments a single template argument list can have.
+        std::size_t max_template_args = 0;
+    };
+
+    // Counters describing the work done by the parser, to find out why some inputs are slow.
+    // This is only filled if `CPPDECL_PARSE_STATS` is enabled (see `platform.h`), and if you set `ParseContext::stats` to point to it.
+    struct ParseStats
+    {
+        // How many candidate interpretations `ParseDecl()` compared (see `ParseLimits::max_alternatives`).
+        std::size_t candidates = 0;
+
+        // How many times the parser rewound the input to try something else: retrying a declaration after a `(`,
+        //   falling back from the fast path of `ParseType()`, or from a type to an expression in a template argument.
+        std::size_t backtracks = 0;
+
+        // How many times `ParseDecl()` copied the declaration to retry it after a `(` that could start a function parameter list.
+        std::size_t open_paren_backups = 0;
+
+        // How many nested `ParseDecl()` calls there were (for function parameters and for the empty return type candidates),
+        //   and how many of those were answered from the memo without parsing.
+        std::size_t decl_reentries = 0;
+        std::size_t decl_memo_hits = 0;
+
+        // How many template arguments failed to parse as types, and were parsed as expressions instead.
+        std::size_t pseudo_expr_fallbacks = 0;
+
+        // How many characters were consumed by the identifiers and the expression tokens, including the repeated parses of the same input.
+        // This doesn't count the whitespace and the punctuation outside of expressions.
+        std::size_t bytes_scanned = 0;
+    };
+
+    // Tells the parser which names are types, to discard the interpretations that contradict that early, instead of returning them as ambiguities.
+    // E.g. in `int(x(y))` the `y` can be either a parameter name or a parameter type, but not if we know that it's a type.
+    // Set `ParseContext::type_oracle` to use this.
+    struct TypeOracle
+    {
+        // Return true if `name` is certainly a type, false if it's certainly not a type, or null if you don't know.
+        // This isn't called for the keywords (such as `int`), and for the special names (such as operators and destructors).
+        [[nodiscard]] virtual CPPDECL_CONSTEXPR std::optional<bool> IsType(const QualifiedName &name) const = 0;
+
+      protected:
+        CPPDECL_CONSTEXPR ~TypeOracle() = default;
+    };
+
+    // A `TypeOracle` that calls a function `(const QualifiedName &) -> std::optional<bool>`, e.g. a lambda that looks up the name in a set.
+    template <typename F>
+    class FuncTypeOracle final : public TypeOracle
+    {
+        F func;
+
+      public:
+        CPPDECL_CONSTEXPR FuncTypeOracle(F func) : func(std::move(func)) {}
+
+        [[nodiscard]] CPPDECL_CONSTEXPR std::optional<bool> IsType(const QualifiedName &name) const override
+        {
+            return func(name);
+        }
+    };
+
+    enum class ParseAttributeListFlags
+    {
+        allow_cpp_style_attrs = 1 << 0,
+        allow_gnu_style_attrs = 1 << 1,
+
+        // Don't parse the attributes, only check that the brackets are balanced, and throw them away. This is much cheaper if you don't need them.
+        // The check is approximate, e.g. `[[a][b]]` is accepted. If the brackets don't look balanced, we parse the attributes normally to report the error.
+        discard = 1 << 2,
+        // Same, but keep each attribute list (e.g. `[[a, b]]`) as a single `Attribute` with its spelling in `raw_text` and an empty `expr`.
+        keep_raw_text = 1 << 3,
+
+        // C++-style attributes applying to the entire declaration can only appear before a declaration.
+        // But GNU-style attributes can appear anywhere IN the decl-specifier-seq as well, and seem to apply to the entire declaration regardless: `long __attribute__((__noreturn__)) long foo() {return 42;}`.
+        // Note that we don't permit C++-style attributes before a lone `SimpleType` at all, e.g. because they don't work in template argument lists.
+        before_decl = allow_cpp_style_attrs | allow_gnu_style_attrs,
+        in_simple_type = allow_gnu_style_attrs,
+    };
+    CPPDECL_FLAG_OPERATORS(ParseAttributeListFlags)
+
+    enum class ParseDeclFlags; // Defined below.
+    using ParseDeclResult = std::variant<MaybeAmbiguousDecl, ParseError>;
+
+    namespace detail::Parse
+    {
+        // Those are the temporary objects of `ParseDecl()`. They're here to be able to store them in `ParseScratch`.
+
+        // A `(` in a declarator, which may turn out to start a function parameter list instead.
+        // The `.location` of this points to the `(` itself.
+        struct OpenParen {};
+
+        // The declarators that go before the name (or where the name would be) are pushed to a stack, and are then applied to the type in reverse order.
+        struct DeclaratorStackEntry
+        {
+            using Var = std::variant<OpenParen, Pointer, Reference, MemberPointer>;
+            Var var;
+
+            std::string_view location; // Copy of the input string right BEFORE this was parsed.
+        };
+
+        // One of the interpretations of a declaration.
+        struct DeclCandidate
+        {
+            ParseDeclResult ret;
+            std::string_view input; // The state of input after parsing.
+        };
+
+        // The decl-specifier-seq (with the leading attributes) that `ParseDeclList()` shares between its declarators.
+        struct SharedDeclSpecifiers
+        {
+            SimpleType simple_type;
+            // Whether there were any C++-style attributes. This is stored separately, because `ParseAttributeListFlags::discard` drops them from `simple_type`.
+            bool have_cpp_style_attrs = false;
+        };
+
+        // A call remembered by `DeclMemo`.
+        struct DeclMemoEntry
+        {
+            const char *input_begin = nullptr;
+            std::size_t input_size = 0; // This is the hash key, since all nested calls share the same end of the input.
+            ParseDeclFlags flags{};
+
+            // Null if this call only happened once so far.
+            std::optional<ParseDeclResult> result;
+            std::string_view input_after;
+
+            // The size of `result` as reported by `Measure()`. Each reuse of the result copies it, so it's counted towards the limits again.
+            // Otherwise the limits wouldn't bound the work on inputs where the results nest exponentially, such as `int(x(y(z(w))))`.
+            std::size_t num_nodes = 0;
+            std::size_t num_alternatives = 0;
+        };
+
+        // Keeps the vectors that are no longer used, to reuse their storage.
+        template <typename T>
+        struct VectorPool
+        {
+            std::vector<std::vector<T>> vectors;
+
+            // Returns an empty vector, preferably one that already has some capacity.
+            [[nodiscard]] CPPDECL_CONSTEXPR std::vector<T> Acquire()
+            {
+                std::vector<T> ret;
+                if (!vectors.empty())
+                {
+                    ret = std::move(vectors.back());
+                    vectors.pop_back();
+                }
+                return ret;
+            }
+
+            CPPDECL_CONSTEXPR void Release(std::vector<T> &&vec)
+            {
+                // Don't bother with the vectors that never allocated. This way a context used only once doesn't allocate anything extra.
+                if (vec.capacity() == 0)
+                    return;
+                vec.clear();
+                vectors.push_back(std::move(vec));
+            }
+        };
+
+        // Acquires a vector from a `VectorPool` for the lifetime of this object.
+        template <typename T>
+        struct PooledVector
+        {
+            VectorPool<T> &pool;
+            std::vector<T> vec;
+
+            CPPDECL_CONSTEXPR PooledVector(VectorPool<T> &pool) : pool(pool), vec(pool.Acquire()) {}
+
+            PooledVector(const PooledVector &) = delete;
+            PooledVector &operator=(const PooledVector &) = delete;
+
+            CPPDECL_CONSTEXPR ~PooledVector()
+            {
+                pool.Release(std::move(vec));
+            }
+        };
+
+        // The temporary storage of the parser, reused across calls. See `ParseContext::scratch`.
+        // We need a pool for each kind of vector, because the calls are nested.
+        struct ParseScratch
+        {
+            VectorPool<DeclaratorStackEntry> declarator_stacks;
+            VectorPool<DeclCandidate> decl_candidates;
+            VectorPool<DeclMemoEntry> decl_memo_entries;
+            VectorPool<std::size_t> decl_memo_slots;
+        };
+    }
+
+    // The state shared by the nested calls during a single top-level parse.
+    // You normally don't need this, unless you want to set `limits`, or to check how many nodes were created.
+    // It can be reused for several parses. `ParseDecl()`, `ParseDeclList()`, `ParseType()` and `MaterializeTemplateArgs()` reset the per-parse state
+    //   (`num_nodes`, `num_alternatives` and `limit_error`) when they start, unless they're called from another parse. Other functions don't reset it.
+    struct ParseContext
+    {
+        ParseLimits limits{};
+
+        // The per-parse state:
+
+        // The current nesting depth. Zero when no parsing is in progress.
+        std::size_t depth = 0;
+
+        // The number of nodes created so far in the current parse.
+        std::size_t num_nodes = 0;
+
+        // The number of extra interpretations tried so far in the current parse, see `ParseLimits::max_alternatives`.
+        std::size_t num_alternatives = 0;
+
+        // Once any of the `limits` is exceeded, this is set, and the rest of the current parse fails immediately.
+        // Otherwise the parser would keep trying other interpretations of the input, which can take exponential time on pathological inputs.
+        // `ParseType()` and `ParseDecl()` check this before returning, so they fail even if they found another interpretation that fits into the limits.
+        ParseError limit_error{};
+
+        // Whether a top-level parse is in progress, see `detail::Parse::TopLevelGuard`.
+        bool parse_in_progress = false;
+
+        // The options, and the state reused across parses:
+
+        // Those are added to the flags of every `ParseAttributeList()` call, including the ones made by `ParseDecl()` and `ParseType()`.
+        // This is intended for `ParseAttributeListFlags::discard` and `keep_raw_text`, if you don't need the attributes.
+        ParseAttributeListFlags attribute_flags{};
+
+        // If not null, the parser asks this whether the names are types. See `TypeOracle`.
+        const TypeOracle *type_oracle = nullptr;
+
+        // If true, the template argument lists are only checked for balanced brackets and stored as text in `TemplateArgumentList::unparsed`.
+        // This is much cheaper if you only look at the outer names. They're parsed on demand, see `MaterializeTemplateArgs()`.
+        // Note that the errors in the template arguments are only reported when they're materialized.
+        bool lazy_template_args = false;
+
+        // If not null, the parser counts its work here. This is ignored without `CPPDECL_PARSE_STATS`.
+        // This member exists regardless of that macro, to keep the layout of this struct the same in all translation units.
+        ParseStats *stats = nullptr;
+
+        // The temporary vectors of the parser are kept here between the calls, to reuse their storage.
+        // If you parse a lot of inputs, keep one context per thread and pass it to every call, then in the steady state
+        //   the parser only allocates memory for the results.
+        detail::Parse::ParseScratch scratch{};
+
+        // Asks the `type_oracle` (if any) whether `name` is a type. Returns null if we don't know.
+        [[nodiscard]] CPPDECL_CONSTEXPR std::optional<bool> IsKnownType(const QualifiedName &name) const
+        {
+            if (!type_oracle || name.parts.empty() || !std::holds_alternative<std::string>(name.parts.back().var) || ClassifyKeyword(name.AsSingleWord()).categories != KeywordCategories{})
+                return {};
+            return type_oracle->IsType(name);
+        }
+
+        // Adds `n` to the `field` of `*stats`, if enabled. This compiles to nothing without `CPPDECL_PARSE_STATS`.
+        CPPDECL_CONSTEXPR void CountStat(std::size_t ParseStats::*field, std::size_t n = 1)
+        {
+            #if CPPDECL_PARSE_STATS
+            if (stats)
+                stats->*field += n;
+            #else
+            (void)field;
+            (void)n;
+            #endif
+        }
+
+        // Sets `limit_error` to `message` and returns it.
+        CPPDECL_CONSTEXPR ParseError ExceedLimit(const char *message)
+        {
+            limit_error.message = message;
+            return limit_error;
+        }
+
+        // Counts `n` new nodes. Returns a null message on success, or an error if this exceeds `limits.max_nodes` (or if some limit was already exceeded before).
+        [[nodiscard]] CPPDECL_CONSTEXPR ParseError AddNodes(std::size_t n = 1)
+        {
+            if (limit_error.message)
+                return limit_error;
+            num_nodes += n;
+            if (limits.max_nodes != 0 && num_nodes > limits.max_nodes)
+                return ExceedLimit("Exceeded the maximum number of nodes.");
+            return {};
+        }
+
+        // Counts `n` extra interpretations of a declaration. Returns a null message on success, or an error if this exceeds `limits.max_alternatives` (or if some limit was already exceeded before).
+        [[nodiscard]] CPPDECL_CONSTEXPR ParseError AddAlternatives(std::size_t n)
+        {
+            if (limit_error.message)
+                return limit_error;
+            num_alternatives += n;
+            if (limits.max_alternatives != 0 && num_alternatives > limits.max_alternatives)
+                return ExceedLimit("Exceeded the maximum number of alternatives.");
+            return {};
+        }
+    };
+
+    namespace detail::Parse
+    {
+        // Increments `ParseContext::depth` for the duration of a nested call, and counts the node that the call produces.
+        // Check `.error` right after constructing this.
+        struct NestingGuard
+        {
+            ParseContext &context;
+            ParseError error;
+
+            CPPDECL_CONSTEXPR NestingGuard(ParseContext &context) : context(context)
+            {
+                context.depth++;
+                if (context.limits.max_depth != 0 && context.depth > context.limits.max_depth && !context.limit_error.message)
+                    error = context.ExceedLimit("Exceeded the maximum nesting depth.");
+                else
+                    error = context.AddNodes();
+            }
+
+            NestingGuard(const NestingGuard &) = delete;
+            NestingGuard &operator=(const NestingGuard &) = delete;
+
+            CPPDECL_CONSTEXPR ~NestingGuard()
+            {
+                context.depth--;
+            }
+        };
+
+        // Used by the top-level parsing functions. If no other parse is in progress, resets the per-parse state of the `context`, so it can be reused.
+        struct TopLevelGuard
+        {
+            ParseContext &context;
+            bool is_outermost = false;
+
+            CPPDECL_CONSTEXPR TopLevelGuard(ParseContext &context) : context(context), is_outermost(!context.parse_in_progress)
+            {
+                if (is_outermost)
+                {
+                    context.num_nodes = 0;
+                    context.num_alternatives = 0;
+                    context.limit_error = {};
+                    context.parse_in_progress = true;
+                }
+            }
+
+            TopLevelGuard(const TopLevelGuard &) = delete;
+            TopLevelGuard &operator=(const TopLevelGuard &) = delete;
+
+            CPPDECL_CONSTEXPR ~TopLevelGuard()
+            {
+                if (is_outermost)
+                    context.parse_in_progress = false;
+            }
+        };
+
+        // Whether the `'` at `input[i]` starts a character literal, as opposed to being a digit separator.
+        // It starts a literal if it doesn't follow an identifier character, or if it follows an encoding prefix (`L`, `u`, `U`, `u8`) that isn't a part of a longer identifier.
+        [[nodiscard]] constexpr bool IsCharLiteralStart(std::string_view input, std::size_t i)
+        {
+            if (i == 0 || !IsIdentifierChar(input[i - 1]))
+                return true;
+
+            const std::string_view before = input.substr(0, i);
+            for (std::string_view prefix : {"L", "u", "U", "u8"})
+            {
+                if (before.ends_with(prefix) && (before.size() == prefix.size() || !IsIdentifierChar(before[before.size() - prefix.size() - 1])))
+                    return true;
+            }
+            return false;
+        }
+
+        // Given `input` starting with a bracket (`<`, `(`, `[`, or `{`), consumes everything up to and including the matching closing bracket, and returns true.
+        // This is approximate: we count the brackets, and skip string and character literals. `<` and `>` are only counted outside of `(...)`, `[...]` and `{...}`.
+        // Returns false if this doesn't look balanced, or if we see something we can't handle. Then the input is unchanged.
+        [[nodiscard]] constexpr bool ConsumeBalancedBrackets(std::string_view &input)
+        {
+            // This is enough for any sane input. If we run out of it, we give up and fall back to the normal parser.
+            std::array<char, 64> stack{};
+            std::size_t depth = 0;
+
+            std::size_t i = 0;
+            while (true)
+            {
+                // Skip to the next character that we care about.
+                std::size_t next = FindAnyOf(input.substr(i), "<([{>)]}\"'");
+                if (next == std::string_view::npos)
+                    break;
+                i += next;
+
+                char ch = input[i];
+
+                if (ch == '<' || ch == '(' || ch == '[' || ch == '{')
+                {
+                    // `<` only nests if we're directly inside `<...>`, otherwise it's an operator.
+                    if (ch != '<' || depth == 0 || stack[depth - 1] == '<')
+                    {
+                        if (depth == stack.size())
+                            return false;
+                        stack[depth++] = ch;
+                    }
+                }
+                else if (ch == '>' || ch == ')' || ch == ']' || ch == '}')
+                {
+                    if (ch != '>' || stack[depth - 1] == '<')
+                    {
+                        char expected_open = ch == '>' ? '<' : ch == ')' ? '(' : ch == ']' ? '[' : '{';
+                        if (stack[depth - 1] != expected_open)
+                            return false;
+
+                        if (--depth == 0)
+                        {
+                            input.remove_prefix(i + 1);
+                            return true;
+                        }
+                    }
+                }
+                else if (ch == '"' || (ch == '\'' && IsCharLiteralStart(input, i))) // Not a digit separator.
+                {
+                    // A raw string literal? Don't bother with those.
+                    if (ch == '"' && i > 0 && input[i - 1] == 'R')
+                        return false;
+
+                    // Skip the literal.
+                    i++;
+                    while (i < input.size() && input[i] != ch)
+                    {
+                        if (input[i] == '\\')
+                            i++;
+                        i++;
+                    }
+                    if (i >= input.size())
+                        return false;
+                }
+
+                i++;
+            }
+
+            return false;
+        }
+    }
+
+
+    // All parsing functions below that recurse have two overloads: one that accepts a `ParseContext &` as the last parameter,
+    //   and one that doesn't and uses a default-constructed context (with no limits).
 
     using ParseTemplateArgumentListResult = std::variant<std::optional<TemplateArgumentList>, ParseError>;
-    [[nodiscard]] CPPDECL_CONSTEXPR ParseTemplateArgumentListResult ParseTemplateArgumentList(std::string_view &input);
+    [[nodiscard]] CPPDECL_CONSTEXPR ParseTemplateArgumentListResult ParseTemplateArgumentList(std::string_view &input, ParseContext &context);
+    [[nodiscard]] CPPDECL_CONSTEXPR ParseTemplateArgumentListResult ParseTemplateArgumentList(std::string_view &input)
+    {
+        ParseContext context;
+        return ParseTemplateArgumentList(input, context);
+    }
 
 
     enum class ParseTypeFlags
@@ -37,11 +499,20 @@ namespace cppdecl
         // Accept only the declarators that would be to the left of a variable name, stop on those that would be to the right.
         // Also don't accept `(`.
         only_left_side_declarators_without_parens = 1 << 0,
+
+        // Always use the general parser, even for the simple types that normally take the fast path. This is mostly for testing.
+        // The result should be the same either way.
+        no_fast_path = 1 << 1,
     };
     CPPDECL_FLAG_OPERATORS(ParseTypeFlags)
 
     using ParseTypeResult = std::variant<Type, ParseError>;
-    [[nodiscard]] CPPDECL_CONSTEXPR ParseTypeResult ParseType(std::string_view &input, ParseTypeFlags flags = {});
+    [[nodiscard]] CPPDECL_CONSTEXPR ParseTypeResult ParseType(std::string_view &input, ParseTypeFlags flags, ParseContext &context);
+    [[nodiscard]] CPPDECL_CONSTEXPR ParseTypeResult ParseType(std::string_view &input, ParseTypeFlags flags = {})
+    {
+        ParseContext context;
+        return ParseType(input, flags, context);
+    }
 
 
     enum class ParseSimpleTypeFlags
@@ -59,7 +530,12 @@ namespace cppdecl
     CPPDECL_FLAG_OPERATORS(ParseSimpleTypeFlags)
 
     using ParseSimpleTypeResult = std::variant<SimpleType, ParseError>;
-    [[nodiscard]] CPPDECL_CONSTEXPR ParseSimpleTypeResult ParseSimpleType(std::string_view &input, ParseSimpleTypeFlags flags = {});
+    [[nodiscard]] CPPDECL_CONSTEXPR ParseSimpleTypeResult ParseSimpleType(std::string_view &input, ParseSimpleTypeFlags flags, ParseContext &context);
+    [[nodiscard]] CPPDECL_CONSTEXPR ParseSimpleTypeResult ParseSimpleType(std::string_view &input, ParseSimpleTypeFlags flags = {})
+    {
+        ParseContext context;
+        return ParseSimpleType(input, flags, context);
+    }
 
 
     enum class ParsePseudoExprFlags
@@ -77,29 +553,27 @@ namespace cppdecl
     // Parse an expression. Even though we call those expressions, it's a fairly loose collection of tokens.
     // We continue parsing until we hit a comma or a closing bracket: `)`,`}`,`]`,`>`.
     // Can return an empty expression.
-    [[nodiscard]] CPPDECL_CONSTEXPR ParsePseudoExprResult ParsePseudoExpr(std::string_view &input, ParsePseudoExprFlags flags = {});
-
-
-    enum class ParseAttributeListFlags
+    [[nodiscard]] CPPDECL_CONSTEXPR ParsePseudoExprResult ParsePseudoExpr(std::string_view &input, ParsePseudoExprFlags flags, ParseContext &context);
+    [[nodiscard]] CPPDECL_CONSTEXPR ParsePseudoExprResult ParsePseudoExpr(std::string_view &input, ParsePseudoExprFlags flags = {})
     {
-        allow_cpp_style_attrs = 1 << 0,
-        allow_gnu_style_attrs = 1 << 1,
+        ParseContext context;
+        return ParsePseudoExpr(input, flags, context);
+    }
 
-        // C++-style attributes applying to the entire declaration can only appear before a declaration.
-        // But GNU-style attributes can appear anywhere IN the decl-specifier-seq as well, and seem to apply to the entire declaration regardless: `long __attribute__((__noreturn__)) long foo() {return 42;}`.
-        // Note that we don't permit C++-style attributes before a lone `SimpleType` at all, e.g. because they don't work in template argument lists.
-        before_decl = allow_cpp_style_attrs | allow_gnu_style_attrs,
-        in_simple_type = allow_gnu_style_attrs,
-    };
-    CPPDECL_FLAG_OPERATORS(ParseAttributeListFlags)
 
     using ParseAttributeListResult = std::variant<AttributeList, ParseError>;
-    [[nodiscard]] CPPDECL_CONSTEXPR ParseAttributeListResult ParseAttributeList(std::string_view &input, ParseAttributeListFlags flags);
+    // If `out_have_cpp_style_attrs` isn't null, it's set to true if we've seen any C++-style attribute lists, even if they were discarded.
+    [[nodiscard]] CPPDECL_CONSTEXPR ParseAttributeListResult ParseAttributeList(std::string_view &input, ParseAttributeListFlags flags, ParseContext &context, bool *out_have_cpp_style_attrs = nullptr);
+    [[nodiscard]] CPPDECL_CONSTEXPR ParseAttributeListResult ParseAttributeList(std::string_view &input, ParseAttributeListFlags flags)
+    {
+        ParseContext context;
+        return ParseAttributeList(input, flags, context);
+    }
 
     // Runs `ParseAttributeList()` and appends the result to `target`. On success returns a null message. On failure returns the error.
-    [[nodiscard]] CPPDECL_CONSTEXPR ParseError ParseAndAppendAttributeList(std::string_view &input, AttributeList &target, ParseAttributeListFlags flags)
+    [[nodiscard]] CPPDECL_CONSTEXPR ParseError ParseAndAppendAttributeList(std::string_view &input, AttributeList &target, ParseAttributeListFlags flags, ParseContext &context, bool *out_have_cpp_style_attrs = nullptr)
     {
-        auto ret = ParseAttributeList(input, flags);
+        auto ret = ParseAttributeList(input, flags, context, out_have_cpp_style_attrs);
         if (auto error = std::get_if<ParseError>(&ret))
             return *error;
 
@@ -108,6 +582,11 @@ namespace cppdecl
 
         return {};
     }
+    [[nodiscard]] CPPDECL_CONSTEXPR ParseError ParseAndAppendAttributeList(std::string_view &input, AttributeList &target, ParseAttributeListFlags flags)
+    {
+        ParseContext context;
+        return ParseAndAppendAttributeList(input, target, flags, context);
+    }
 
 
     using ParseQualifiersResult = std::variant<CvQualifiers, ParseError>;
@@ -130,25 +609,30 @@ namespace cppdecl
 
             CvQualifiers bit{};
 
-            if (ConsumeWord(input_copy, "const"))
-                bit = CvQualifiers::const_;
-            else if (ConsumeWord(input_copy, "volatile"))
-                bit = CvQualifiers::volatile_;
-            // Here we include the non-conformant (`restrict`) spelling too. TODO a flag to only allow conformant C++ spellings?
-            else if (ConsumeWord(input_copy, "__restrict") || ConsumeWord(input_copy, "__restrict__") || ConsumeWord(input_copy, "restrict"))
-                bit = CvQualifiers::restrict_;
-            // Weird MSVC stuff: [
-            else if (ConsumeWord(input_copy, "__ptr32"))
-                bit = CvQualifiers::msvc_ptr32;
-            else if (ConsumeWord(input_copy, "__ptr64"))
-                bit = CvQualifiers::msvc_ptr64;
-            else if (ConsumeWord(input_copy, "__unaligned"))
-                bit = CvQualifiers::msvc_unaligned;
-            // ]
+            // Read the word once, then look it up.
+            const std::string_view word = PeekIdentifierChars(input_copy);
+
+            switch (ClassifyKeyword(word).id)
+            {
+                case Keyword::const_:    bit = CvQualifiers::const_;    break;
+                case Keyword::volatile_: bit = CvQualifiers::volatile_; break;
+                // Here we include the non-conformant (`restrict`) spelling too. TODO a flag to only allow conformant C++ spellings?
+                case Keyword::gnu_restrict:
+                case Keyword::gnu_restrict2:
+                case Keyword::restrict_: bit = CvQualifiers::restrict_; break;
+                // Weird MSVC stuff: [
+                case Keyword::msvc_ptr32:     bit = CvQualifiers::msvc_ptr32;     break;
+                case Keyword::msvc_ptr64:     bit = CvQualifiers::msvc_ptr64;     break;
+                case Keyword::msvc_unaligned: bit = CvQualifiers::msvc_unaligned; break;
+                // ]
+                default: break;
+            }
 
             if (!bool(bit))
                 return ret;
 
+            input_copy.remove_prefix(word.size());
+
             if (bool(bit & ret_quals))
             {
                 input = input_copy_after_whitespace;
@@ -189,19 +673,15 @@ namespace cppdecl
     // Returns `SimpleTypePrefix::none` for unknown strings.
     [[nodiscard]] CPPDECL_CONSTEXPR SimpleTypePrefix StringToSimpleTypePrefix(std::string_view str)
     {
-        if (str == "struct")
-            return SimpleTypePrefix::struct_;
-        if (str == "class")
-            return SimpleTypePrefix::class_;
-        if (str == "union")
-            return SimpleTypePrefix::union_;
-        if (str == "enum")
-            return SimpleTypePrefix::enum_;
-
-        if (str == "typename")
-            return SimpleTypePrefix::typename_;
-
-        return SimpleTypePrefix::none;
+        switch (ClassifyKeyword(str).id)
+        {
+            case Keyword::struct_:   return SimpleTypePrefix::struct_;
+            case Keyword::class_:    return SimpleTypePrefix::class_;
+            case Keyword::union_:    return SimpleTypePrefix::union_;
+            case Keyword::enum_:     return SimpleTypePrefix::enum_;
+            case Keyword::typename_: return SimpleTypePrefix::typename_;
+            default:                 return SimpleTypePrefix::none;
+        }
     }
 
 
@@ -305,7 +785,7 @@ namespace cppdecl
     // When `input` is modified, the trailing whitespace is stripped automatically. This happens even if there was nothing to parse.
     // If the input ends with `:: * [cv]` (as in a member pointer), returns a `MemberPointer` instead of a `QualifiedName`.
     // NOTE: This doesn't understand `long long` (hence "Low"), use `ParseDecl()` to support that.
-    [[nodiscard]] CPPDECL_CONSTEXPR ParseQualifiedNameResult ParseQualifiedName(std::string_view &input, ParseQualifiedNameFlags flags = {})
+    [[nodiscard]] CPPDECL_CONSTEXPR ParseQualifiedNameResult ParseQualifiedName(std::string_view &input, ParseQualifiedNameFlags flags, ParseContext &context)
     {
         ParseQualifiedNameResult ret;
 
@@ -346,11 +826,15 @@ namespace cppdecl
             {
                 const std::string_view input_before_this_unqual_part = s; // Sic, not `= input`.
 
+                if (auto error = context.AddNodes(); error.message)
+                    return input = s, ret = error, ret;
+
                 bool stop_on_this_iteration = false;
 
                 // Check if we got an unspellable name?
+                // All of them start with one of those characters, so we check it first, to avoid trying all the spellings on every identifier.
                 std::string_view unsp_name;
-                if (!bool(flags & ParseQualifiedNameFlags::only_spellable_names))
+                if (!bool(flags & ParseQualifiedNameFlags::only_spellable_names) && !s.empty() && std::string_view("<'`({$").find(s.front()) != std::string_view::npos)
                 {
                     auto TryExactString = [&](std::string_view target) -> bool
                     {
@@ -407,7 +891,7 @@ namespace cppdecl
                                 if (param_list && s_copy.starts_with('('))
                                 {
                                     // Use `ParsePseudoExpr()` to consume this list. Perhaps not very efficient, since we don't save it anywhere, but very convenient.
-                                    if (!std::holds_alternative<ParseError>(ParsePseudoExpr(s_copy, ParsePseudoExprFlags::stop_after_one_token)))
+                                    if (!std::holds_alternative<ParseError>(ParsePseudoExpr(s_copy, ParsePseudoExprFlags::stop_after_one_token, context)))
                                         param_list = false; // Success.
                                 }
 
@@ -538,7 +1022,7 @@ namespace cppdecl
                     // Looks like a destructor.
                     TrimLeadingWhitespace(s);
 
-                    auto type_result = ParseSimpleType(s, ParseSimpleTypeFlags::only_unqualified | ParseSimpleTypeFlags::no_type_prefix);
+                    auto type_result = ParseSimpleType(s, ParseSimpleTypeFlags::only_unqualified | ParseSimpleTypeFlags::no_type_prefix, context);
                     if (auto error = std::get_if<ParseError>(&type_result))
                     {
                         input = s;
@@ -560,15 +1044,9 @@ namespace cppdecl
                     if (s.empty() || !IsNonDigitIdentifierChar(s.front()))
                         break;
 
-                    const char *cur = s.data();
-
-                    do
-                        cur++;
-                    while (cur < input.data() + input.size() && IsIdentifierChar(*cur));
-
-                    std::string_view new_word = std::string_view(s.data(), cur);
-                    s.remove_prefix(std::size_t(cur - s.data()));
+                    std::string_view new_word = ConsumeIdentifierChars(s);
                     TrimLeadingWhitespace(s);
+                    context.CountStat(&ParseStats::bytes_scanned, new_word.size());
 
                     bool maybe_multiword_type = false;
 
@@ -671,12 +1149,7 @@ namespace cppdecl
                                 return ret;
                             }
 
-                            do
-                            {
-                                udl.suffix += s.front();
-                                s.remove_prefix(1);
-                            }
-                            while (!s.empty() && IsIdentifierChar(s.front()));
+                            udl.suffix = ConsumeIdentifierChars(s);
                         }
                         else if (std::string_view op_token; ConsumeOperatorToken(s, op_token))
                         {
@@ -687,7 +1160,7 @@ namespace cppdecl
                         else
                         {
                             // Has to be a conversion operator at this point.
-                            auto type_result = ParseType(s, ParseTypeFlags::only_left_side_declarators_without_parens);
+                            auto type_result = ParseType(s, ParseTypeFlags::only_left_side_declarators_without_parens, context);
                             if (auto error = std::get_if<ParseError>(&type_result))
                             {
                                 input = s;
@@ -710,7 +1183,7 @@ namespace cppdecl
                     // Consume the template arguments, if any.
                     if (!maybe_multiword_type)
                     {
-                        auto arglist_result = ParseTemplateArgumentList(input);
+                        auto arglist_result = ParseTemplateArgumentList(input, context);
                         if (auto error = std::get_if<ParseError>(&arglist_result))
                             return ret = *error, ret;
                         new_unqual_part.template_args = std::move(std::get<std::optional<TemplateArgumentList>>(arglist_result));
@@ -728,16 +1201,9 @@ namespace cppdecl
 
                             s = input;
 
-                            std::string_view new_word(s.data(), 0);
-
-                            do
-                            {
-                                new_word = {new_word.data(), new_word.size() + 1}; // Grow `new_word` by 1.
-                                s.remove_prefix(1);
-                            }
-                            while (!s.empty() && IsIdentifierChar(s.front()));
-
+                            std::string_view new_word = ConsumeIdentifierChars(s);
                             TrimLeadingWhitespace(s);
+                            context.CountStat(&ParseStats::bytes_scanned, new_word.size());
 
                             auto add_result = TryAddWordToQualifiedName(ret_name, new_word, {});
                             if (auto error = std::get_if<ParseError>(&add_result))
@@ -783,6 +1249,8 @@ namespace cppdecl
                             input = s;
                             if (auto error = std::get_if<ParseError>(&parsed_quals))
                                 return ret = *error, ret;
+                            if (auto error = context.AddNodes(); error.message)
+                                return ret = error, ret;
                             MemberPointer memptr;
                             memptr.quals = std::get<CvQualifiers>(parsed_quals);
                             memptr.base = std::move(ret_name);
@@ -790,6 +1258,10 @@ namespace cppdecl
                             return ret;
                         }
 
+                        // Names with more than one part usually have 2-4 of them. Reserve to avoid reallocating on every part.
+                        if (ret_name.parts.size() == 1)
+                            ret_name.parts.reserve(4);
+
                         continue;
                     }
                 }
@@ -827,6 +1299,11 @@ namespace cppdecl
 
         return ret;
     }
+    [[nodiscard]] CPPDECL_CONSTEXPR ParseQualifiedNameResult ParseQualifiedName(std::string_view &input, ParseQualifiedNameFlags flags = {})
+    {
+        ParseContext context;
+        return ParseQualifiedName(input, flags, context);
+    }
 
 
     // Tries to modify this type by adding another name to it.
@@ -840,15 +1317,16 @@ namespace cppdecl
             return false; // The name is empty, nothing to do.
 
         const std::string_view word = new_name.AsSingleWord();
+        const KeywordInfo keyword = ClassifyKeyword(word);
 
-        if (word == "const")
+        if (keyword.id == Keyword::const_)
         {
             if (bool(type.quals & CvQualifiers::const_))
                 return ParseError{.message = "Repeated `const`."};
             type.quals |= CvQualifiers::const_;
             return true;
         }
-        if (word == "volatile")
+        if (keyword.id == Keyword::volatile_)
         {
             if (bool(type.quals & CvQualifiers::volatile_))
                 return ParseError{.message = "Repeated `volatile`."};
@@ -856,7 +1334,7 @@ namespace cppdecl
             return true;
         }
         // No `__ptr32` and `__ptr64` here. Only `ParseCvQualifiers()` needs to handle them.
-        if (word == "__unaligned")
+        if (keyword.id == Keyword::msvc_unaligned)
         {
             // It's a bit ass to have to handle `"__unaligned"` both here and in `ParseCvQualifiers()`.
             // If we get more qualifiers like this, we should unify the logic somehow (but still make sure we reject `__ptr32` and `__ptr64` in the decl-specifier-seq).
@@ -865,7 +1343,7 @@ namespace cppdecl
             type.quals |= CvQualifiers::msvc_unaligned;
             return true;
         }
-        if (word == "unsigned")
+        if (keyword.id == Keyword::unsigned_)
         {
             if (bool(type.flags & SimpleTypeFlags::unsigned_))
                 return ParseError{.message = "Repeated `unsigned`."};
@@ -876,7 +1354,7 @@ namespace cppdecl
             type.flags |= SimpleTypeFlags::unsigned_;
             return true;
         }
-        if (word == "signed")
+        if (keyword.id == Keyword::signed_)
         {
             if (bool(type.flags & SimpleTypeFlags::explicitly_signed))
                 return ParseError{.message = "Repeated `signed`."};
@@ -887,7 +1365,7 @@ namespace cppdecl
             type.flags |= SimpleTypeFlags::explicitly_signed;
             return true;
         }
-        if (word == "_Complex") // For now we don't support the `complex` spelling for sanity (which is a macro in `complex.h`), that sounds too prone to conflicts.
+        if (keyword.id == Keyword::c_complex) // For now we don't support the `complex` spelling for sanity (which is a macro in `complex.h`), that sounds too prone to conflicts.
         {
             if (bool(type.flags & SimpleTypeFlags::c_complex))
                 return ParseError{.message = "Repeated `_Complex`."};
@@ -899,7 +1377,7 @@ namespace cppdecl
             type.flags |= SimpleTypeFlags::c_complex;
             return true;
         }
-        if (word == "_Imaginary") // For now we don't support the `complex` spelling for sanity (which is a macro in `complex.h`), that sounds too prone to conflicts.
+        if (keyword.id == Keyword::c_imaginary) // For now we don't support the `complex` spelling for sanity (which is a macro in `complex.h`), that sounds too prone to conflicts.
         {
             if (bool(type.flags & SimpleTypeFlags::c_imaginary))
                 return ParseError{.message = "Repeated `_Imaginary`."};
@@ -937,7 +1415,7 @@ namespace cppdecl
         }
 
         // `_Complex`/`_Imaginary` + `long`, which then is expected to be followed by a `double`. This has to be a special case, since `long` is otherwise an integral type.
-        if (word == "long" && bool(type.flags & (SimpleTypeFlags::c_complex | SimpleTypeFlags::c_imaginary)))
+        if (keyword.id == Keyword::long_ && bool(type.flags & (SimpleTypeFlags::c_complex | SimpleTypeFlags::c_imaginary)))
         {
             type.name = std::forward<T>(new_name);
             return true;
@@ -968,14 +1446,14 @@ namespace cppdecl
                     return ParseError{.message = "Elaborated type specifier applied to a built-in type."};
             }
 
-            // The move is useless right now, since this is a const reference.
-            // This is probably better than passing by value and always copying though.
+            // Note that we only ever move from `new_name` when returning true, so the callers can pass an rvalue
+            //   and still reuse the name if we return false.
             type.name = std::forward<T>(new_name);
             return true;
         }
 
         // The name being added is a keyword that looks suspicious.
-        if (IsTypeRelatedKeyword(word))
+        if (bool(keyword.categories & KeywordCategories::type_related))
             return ParseError{.message = "Can't add this keyword to the preceding type."};
 
         return false; // Don't know what this is.
@@ -1015,7 +1493,7 @@ namespace cppdecl
 
     // Parse a "simple type". Very similar to `ParseQualifiedName`, but also combines `long` + `long`, and similar things.
     // Returns an empty type if nothing to parse.
-    [[nodiscard]] CPPDECL_CONSTEXPR ParseSimpleTypeResult ParseSimpleType(std::string_view &input, ParseSimpleTypeFlags flags)
+    [[nodiscard]] CPPDECL_CONSTEXPR ParseSimpleTypeResult ParseSimpleType(std::string_view &input, ParseSimpleTypeFlags flags, ParseContext &context)
     {
         ParseSimpleTypeResult ret;
         SimpleType &ret_type = std::get<SimpleType>(ret);
@@ -1029,14 +1507,14 @@ namespace cppdecl
         // Any attributes at the beginning?
         // Note that when parsing `SimpleType`, the first attribute list uses mode `in_simple_type`, as opposed to `before_decl`.
         // That's because C++-style attributes can't appear e.g. in template argument lists.
-        if (auto error = ParseAndAppendAttributeList(input, ret_type.attrs, ParseAttributeListFlags::in_simple_type); error.message)
+        if (auto error = ParseAndAppendAttributeList(input, ret_type.attrs, ParseAttributeListFlags::in_simple_type, context); error.message)
             return ret = error, ret;
 
         while (true)
         {
             const std::string_view input_before_name = input;
 
-            auto name_result = ParseQualifiedName(input, qual_name_flags);
+            auto name_result = ParseQualifiedName(input, qual_name_flags, context);
             if (auto error = std::get_if<ParseError>(&name_result))
                 return ret = *error, ret;
 
@@ -1051,7 +1529,7 @@ namespace cppdecl
             if (new_name.IsEmpty())
                 break; // No more names to parse, stop.
 
-            auto add_name_result = TryAddNameToSimpleType(ret_type, new_name, bool(flags & ParseSimpleTypeFlags::no_type_prefix) * TryAddNameToTypeFlags::no_type_prefix);
+            auto add_name_result = TryAddNameToSimpleType(ret_type, std::move(new_name), bool(flags & ParseSimpleTypeFlags::no_type_prefix) * TryAddNameToTypeFlags::no_type_prefix);
             if (auto error = std::get_if<ParseError>(&add_name_result))
             {
                 input = input_before_name;
@@ -1067,7 +1545,7 @@ namespace cppdecl
             }
 
             // Any attributes after this part?
-            if (auto error = ParseAndAppendAttributeList(input, ret_type.attrs, ParseAttributeListFlags::in_simple_type); error.message)
+            if (auto error = ParseAndAppendAttributeList(input, ret_type.attrs, ParseAttributeListFlags::in_simple_type, context); error.message)
                 return ret = error, ret;
         }
 
@@ -1126,29 +1604,28 @@ namespace cppdecl
         // Then if this turns out to not be a floating-point literal, we roll back the input to this and error.
         std::string_view input_at_bad_octal_digit_in_int;
 
-        auto ConsumeInteger = [&](bool (*digit_validation_func)(char), bool is_seemingly_octal_integral_part = false) -> std::string
+        auto ConsumeInteger = [&](bool (*digit_validation_func)(char), bool is_seemingly_octal_integral_part = false) -> std::string_view
         {
-            std::string ret;
-
             bool allow_apostrophe = is_seemingly_octal_integral_part;
 
             const auto orig_digit_validation_func = digit_validation_func;
             if (is_seemingly_octal_integral_part)
                 digit_validation_func = IsDigit; // See `input_at_bad_octal_digit_in_int` above.
 
-            while (!input.empty())
+            // Find the end first, then consume everything at once.
+            std::size_t i = 0;
+            while (i < input.size())
             {
-                char ch = input.front();
+                char ch = input[i];
 
-                if (digit_validation_func(ch) || (ch == '\'' && allow_apostrophe && input.size() >= 2 && digit_validation_func(input[1])))
+                if (digit_validation_func(ch) || (ch == '\'' && allow_apostrophe && i + 1 < input.size() && digit_validation_func(input[i + 1])))
                 {
-                    ret += ch;
                     allow_apostrophe = ch != '\'';
 
                     if (is_seemingly_octal_integral_part && allow_apostrophe && input_at_bad_octal_digit_in_int.empty() && !orig_digit_validation_func(ch))
-                        input_at_bad_octal_digit_in_int = input;
+                        input_at_bad_octal_digit_in_int = input.substr(i);
 
-                    input.remove_prefix(1);
+                    i++;
                 }
                 else
                 {
@@ -1156,6 +1633,8 @@ namespace cppdecl
                 }
             }
 
+            std::string_view ret = input.substr(0, i);
+            input.remove_prefix(i);
             return ret;
         };
 
@@ -1204,7 +1683,7 @@ namespace cppdecl
 
             // Consume the fractional part.
             // This always makes `ret_float->value_frac` non-null (it is a `std::optional<std::string>`). This is intended, and indicates that we've had a decimal point.
-            ret_float->value_frac = ConsumeInteger(validation_func);
+            ret_float->value_frac = std::string(ConsumeInteger(validation_func));
 
             // Complain if there are no digits both before and after the decimal point.
             if (ret_float->value_int.empty() && ret_float->value_frac->empty())
@@ -1262,11 +1741,7 @@ namespace cppdecl
                 // A floating-point suffix.
 
                 std::string &suffix_str = std::get<std::string>(ret_float->suffix);
-                while (!input.empty() && IsIdentifierChar(input.front()))
-                {
-                    suffix_str += input.front();
-                    input.remove_prefix(1);
-                }
+                suffix_str = ConsumeIdentifierChars(input);
 
                 // Decode the suffix if possible
                 if      (suffix_str == "f" || suffix_str == "F") ret_float->suffix = NumericLiteral::FloatingPoint::Suffix::f;
@@ -1282,11 +1757,7 @@ namespace cppdecl
                 // An integral suffix.
 
                 std::string &suffix_str = std::get<std::string>(ret_int->suffix);
-                while (!input.empty() && IsIdentifierChar(input.front()))
-                {
-                    suffix_str += input.front();
-                    input.remove_prefix(1);
-                }
+                suffix_str = ConsumeIdentifierChars(input);
 
                 // Decode the suffix if possible.
                 NumericLiteral::Integer::Suffix new_suffix;
@@ -1332,13 +1803,17 @@ namespace cppdecl
             }
         }
 
+        // Decode the value once now, so that `ToInteger()` doesn't have to.
+        if (ret_int)
+            ret_int->UpdateCachedValue();
+
         return ret;
     }
 
     // Parse an expression. Even though we call those expressions, it's a fairly loose collection of tokens.
     // We continue parsing until we hit a comma or a closing bracket: `)`,`}`,`]`,`>`.
     // Can return an empty expression.
-    [[nodiscard]] CPPDECL_CONSTEXPR ParsePseudoExprResult ParsePseudoExpr(std::string_view &input, ParsePseudoExprFlags flags)
+    [[nodiscard]] CPPDECL_CONSTEXPR ParsePseudoExprResult ParsePseudoExpr(std::string_view &input, ParsePseudoExprFlags flags, ParseContext &context)
     {
         // Note that we don't propagate any `flags` when recursing.
         // This is undesired for `stop_on_gt_sign` and `stop_after_one_token`, which are currently the only available flags.
@@ -1346,6 +1821,10 @@ namespace cppdecl
         ParsePseudoExprResult ret;
         PseudoExpr &ret_expr = std::get<PseudoExpr>(ret);
 
+        detail::Parse::NestingGuard guard(context);
+        if (guard.error.message)
+            return ret = guard.error, ret;
+
         bool first = true;
 
         while (true)
@@ -1366,6 +1845,12 @@ namespace cppdecl
                 return ret;
             }
 
+            // Each iteration adds one token.
+            if (auto error = context.AddNodes(); error.message)
+                return ret = error, ret;
+
+            const std::string_view input_before_token = input;
+
             { // Number.
                 auto result = ParseNumericLiteral(input);
 
@@ -1375,6 +1860,7 @@ namespace cppdecl
                 if (auto &lit = std::get<std::optional<NumericLiteral>>(result))
                 {
                     ret_expr.tokens.emplace_back(std::move(*lit));
+                    context.CountStat(&ParseStats::bytes_scanned, input_before_token.size() - input.size());
                     continue;
                 }
             }
@@ -1510,6 +1996,7 @@ namespace cppdecl
                     }
 
                     ret_expr.tokens.emplace_back(std::move(lit));
+                    context.CountStat(&ParseStats::bytes_scanned, input_before_token.size() - input.size());
                     continue;
                 }
             }
@@ -1537,7 +2024,7 @@ namespace cppdecl
                         // Parse the elements.
                         while (true)
                         {
-                            auto expr_result = ParsePseudoExpr(input);
+                            auto expr_result = ParsePseudoExpr(input, {}, context);
                             if (auto error = std::get_if<ParseError>(&expr_result))
                                 return ret = *error, ret;
 
@@ -1582,7 +2069,7 @@ namespace cppdecl
             }
 
             { // Template argument list.
-                auto arglist_result = ParseTemplateArgumentList(input);
+                auto arglist_result = ParseTemplateArgumentList(input, context);
                 if (auto error = std::get_if<ParseError>(&arglist_result))
                     return ret = *error, ret;
                 auto &arglist_opt = std::get<std::optional<TemplateArgumentList>>(arglist_result);
@@ -1596,7 +2083,7 @@ namespace cppdecl
             }
 
             { // `SimpleType`, which includes identifiers.
-                auto type_result = ParseSimpleType(input, ParseSimpleTypeFlags::allow_arbitrary_names);
+                auto type_result = ParseSimpleType(input, ParseSimpleTypeFlags::allow_arbitrary_names, context);
                 if (auto error = std::get_if<ParseError>(&type_result))
                     return ret = *error, ret;
 
@@ -1653,6 +2140,7 @@ namespace cppdecl
                 }
 
                 ret_expr.tokens.emplace_back(std::move(punct));
+                context.CountStat(&ParseStats::bytes_scanned, input_before_token.size() - input.size());
             }
         }
     }
@@ -1660,11 +2148,42 @@ namespace cppdecl
 
     // Tries to parse zero or more attributes or even separate attribute lists. Returns an empty list if there are no attributes in the input.
     // Strips both trailing and leading whitespace.
-    [[nodiscard]] CPPDECL_CONSTEXPR ParseAttributeListResult ParseAttributeList(std::string_view &input, ParseAttributeListFlags flags)
+    [[nodiscard]] CPPDECL_CONSTEXPR ParseAttributeListResult ParseAttributeList(std::string_view &input, ParseAttributeListFlags flags, ParseContext &context, bool *out_have_cpp_style_attrs)
     {
         ParseAttributeListResult ret;
         AttributeList &ret_list = std::get<AttributeList>(ret);
 
+        flags |= context.attribute_flags;
+
+        // For `discard` and `keep_raw_text`. `s` must point to the first bracket of the list, and the list must end with `closing`.
+        // If the brackets look balanced, consumes the list (from `list_start`) and returns true.
+        auto SkipList = [&](std::string_view list_start, std::string_view s, Attribute::Style style, char closing) -> bool
+        {
+            if (!bool(flags & (ParseAttributeListFlags::discard | ParseAttributeListFlags::keep_raw_text)))
+                return false;
+
+            if (!detail::Parse::ConsumeBalancedBrackets(s))
+                return false;
+
+            // Check that the list ends with two closing brackets, possibly with whitespace between them.
+            std::string_view list = list_start.substr(0, std::size_t(s.data() - list_start.data()));
+            std::string_view list_copy = list;
+            list_copy.remove_suffix(1);
+            TrimTrailingWhitespace(list_copy);
+            if (!list_copy.ends_with(closing))
+                return false;
+
+            if (bool(flags & ParseAttributeListFlags::keep_raw_text))
+            {
+                Attribute &attr = ret_list.attrs.emplace_back();
+                attr.style = style;
+                attr.raw_text = list;
+            }
+
+            input = s;
+            return true;
+        };
+
         while (true)
         {
             bool progress = false;
@@ -1681,9 +2200,16 @@ namespace cppdecl
                     if (ConsumePunctuation(input_copy, "["))
                     {
                         // Now we're sure we're in an attribute list.
-                        input = input_copy;
                         progress = true;
 
+                        if (out_have_cpp_style_attrs)
+                            *out_have_cpp_style_attrs = true;
+
+                        if (SkipList(input, input, Attribute::Style::cpp, ']'))
+                            continue;
+
+                        input = input_copy;
+
                         TrimLeadingWhitespace(input);
 
                         // See if the attribute list starts with `using NS:`
@@ -1753,7 +2279,7 @@ namespace cppdecl
 
                             // Consume the attribute itself.
                             const std::string_view input_before_expr = input;
-                            auto result = ParsePseudoExpr(input);
+                            auto result = ParsePseudoExpr(input, {}, context);
                             if (auto error = std::get_if<ParseError>(&result))
                                 return ret = *error, ret;
 
@@ -1785,15 +2311,20 @@ namespace cppdecl
                 if (ConsumeWord(input_copy, "__attribute__"))
                 {
                     TrimLeadingWhitespace(input_copy);
+                    const std::string_view input_at_paren = input_copy;
                     if (ConsumePunctuation(input_copy, "("))
                     {
                         TrimLeadingWhitespace(input_copy);
                         if (ConsumePunctuation(input_copy, "("))
                         {
                             // Now we're sure we're in an attribute list.
-                            input = input_copy;
                             progress = true;
 
+                            if (SkipList(input, input_at_paren, Attribute::Style::gnu, ')'))
+                                continue;
+
+                            input = input_copy;
+
                             bool first = true;
                             while (true)
                             {
@@ -1829,7 +2360,7 @@ namespace cppdecl
                                 }
 
                                 // Consume the attribute itself.
-                                auto result = ParsePseudoExpr(input);
+                                auto result = ParsePseudoExpr(input, {}, context);
                                 if (auto error = std::get_if<ParseError>(&result))
                                     return ret = *error, ret;
 
@@ -1895,7 +2426,73 @@ namespace cppdecl
             return bool(flags & ParseDeclFlags::accept_unqualified_named);
     }
 
-    using ParseDeclResult = std::variant<MaybeAmbiguousDecl, ParseError>;
+    namespace detail::Parse
+    {
+        // Remembers the results of the nested `ParseDecl()` calls (for function parameters and for the empty return type candidates)
+        //   during a single top-level `ParseDecl()` call.
+        // When trying different candidates, we often re-parse the same part of the input with the same flags, and without this the parsing time
+        //   grows exponentially with the nesting depth on inputs such as `int(a(b(c(d))))`.
+        // A call is remembered only when it's repeated for the second time, to avoid copying the results in the common case with no repetitions.
+        // This keys on the start of the input only, which is fine because all nested calls share the same end of the input.
+        struct DeclMemo
+        {
+            PooledVector<DeclMemoEntry> entries_storage;
+            std::vector<DeclMemoEntry> &entries = entries_storage.vec;
+
+            // An open-addressing hash table indexing `entries`, to avoid scanning all of them on every call (a function with many parameters
+            //   would then take quadratic time). Each slot is an index in `entries` plus one, or zero if empty.
+            // The size is a power of two, or zero if nothing was added yet.
+            // We don't use `std::unordered_map`, because it's not `constexpr`, and it can't hash pointers at compile-time anyway.
+            PooledVector<std::size_t> slots_storage;
+            std::vector<std::size_t> &slots = slots_storage.vec;
+
+            CPPDECL_CONSTEXPR DeclMemo(ParseContext &context) : entries_storage(context.scratch.decl_memo_entries), slots_storage(context.scratch.decl_memo_slots) {}
+
+            [[nodiscard]] static constexpr std::size_t HashKey(std::size_t input_size, ParseDeclFlags flags)
+            {
+                return input_size * std::size_t(0x9e3779b9) + std::size_t(flags) * std::size_t(0x85ebca6b);
+            }
+
+            // Returns the slot for this call, either the one pointing to its entry, or an empty one where it should be added.
+            // `slots` must not be empty.
+            [[nodiscard]] CPPDECL_CONSTEXPR std::size_t &FindSlot(std::string_view input, ParseDeclFlags flags)
+            {
+                const std::size_t mask = slots.size() - 1;
+                std::size_t i = HashKey(input.size(), flags) & mask;
+                while (true)
+                {
+                    std::size_t &slot = slots[i];
+                    if (slot == 0)
+                        return slot;
+                    const DeclMemoEntry &entry = entries[slot - 1];
+                    if (entry.input_begin == input.data() && entry.flags == flags)
+                        return slot;
+                    i = (i + 1) & mask;
+                }
+            }
+
+            // Makes sure there's room for one more entry in `slots`, keeping the load factor at most 1/2.
+            CPPDECL_CONSTEXPR void ReserveSlot()
+            {
+                if ((entries.size() + 1) * 2 <= slots.size())
+                    return;
+
+                slots.assign(slots.empty() ? 16 : slots.size() * 2, 0);
+                const std::size_t mask = slots.size() - 1;
+                for (std::size_t j = 0; j < entries.size(); j++)
+                {
+                    std::size_t i = HashKey(entries[j].input_size, entries[j].flags) & mask;
+                    while (slots[i] != 0)
+                        i = (i + 1) & mask;
+                    slots[i] = j + 1;
+                }
+            }
+
+            // Calls `ParseDecl()`, or returns the remembered result of the same call.
+            [[nodiscard]] CPPDECL_CONSTEXPR ParseDeclResult ParseDecl(std::string_view &input, ParseDeclFlags flags, ParseContext &context);
+        };
+    }
+
     // Parses a declaration (named or unnamed), returns `ParseError` on failure.
     // Should skip both leading and trailing whitespace.
     // Tries to resolve ambiguities based on `flags`, and based on the amount of characters consumed (more is better).
@@ -1903,7 +2500,26 @@ namespace cppdecl
     //   as function parameters), sets `.IsAmbiguous() == true` in the result, and attaches the ambiguous alternatives
     //   (see `.ambiguous_alternative`). Note that ambiguities can happen not only at the top level, but also in function parameters. `.IsAmbiguous()`
     //   checks for that recursively.
+    [[nodiscard]] CPPDECL_CONSTEXPR ParseDeclResult ParseDecl(std::string_view &input, ParseDeclFlags flags, ParseContext &context, detail::Parse::DeclMemo &memo, const detail::Parse::SharedDeclSpecifiers *reuse_decl_specifiers = nullptr, detail::Parse::SharedDeclSpecifiers *out_decl_specifiers = nullptr);
+    [[nodiscard]] CPPDECL_CONSTEXPR ParseDeclResult ParseDecl(std::string_view &input, ParseDeclFlags flags, ParseContext &context)
+    {
+        detail::Parse::TopLevelGuard top_level_guard(context);
+        detail::Parse::DeclMemo memo(context);
+        ParseDeclResult ret = ParseDecl(input, flags, context, memo);
+        if (context.limit_error.message)
+            ret = context.limit_error;
+        return ret;
+    }
     [[nodiscard]] CPPDECL_CONSTEXPR ParseDeclResult ParseDecl(std::string_view &input, ParseDeclFlags flags)
+    {
+        ParseContext context;
+        return ParseDecl(input, flags, context);
+    }
+
+    // Same, but uses the existing `memo`. This is for internal use, the memo must come from the same top-level call.
+    // If `reuse_decl_specifiers` isn't null, we don't parse the leading attributes and the decl-specifier-seq, and use this instead. This is for `ParseDeclList()`.
+    // If `out_decl_specifiers` isn't null, we write the parsed decl-specifier-seq (with the leading attributes) to it. It's empty if we've chosen an empty return type.
+    [[nodiscard]] CPPDECL_CONSTEXPR ParseDeclResult ParseDecl(std::string_view &input, ParseDeclFlags flags, ParseContext &context, detail::Parse::DeclMemo &memo, const detail::Parse::SharedDeclSpecifiers *reuse_decl_specifiers, detail::Parse::SharedDeclSpecifiers *out_decl_specifiers)
     {
         ParseDeclResult ret;
         MaybeAmbiguousDecl &ret_decl = std::get<MaybeAmbiguousDecl>(ret);
@@ -1918,10 +2534,26 @@ namespace cppdecl
                 return ret = ParseError{.message = "Bad usage, invalid flags: 'Unnamed declarators without parens' mode can only be used with unnamed declarations."}, ret;
         }
 
+        // The empty return type candidate is parsed by a nested call, but it isn't nested in the result, so it doesn't count towards the depth.
+        std::optional<detail::Parse::NestingGuard> guard;
+        if (!bool(flags & ParseDeclFlags::force_empty_return_type))
+        {
+            guard.emplace(context);
+            if (guard->error.message)
+                return ret = guard->error, ret;
+        }
+
 
         // Any attributes at the beginning?
         const std::string_view input_before_first_attr = input;
-        if (auto error = ParseAndAppendAttributeList(input, ret_decl.type.simple_type.attrs, ParseAttributeListFlags::before_decl); error.message)
+        // We can't check `ret_decl.type.simple_type.attrs` for those, because they can be discarded depending on the flags.
+        bool have_cpp_style_attrs = false;
+        if (reuse_decl_specifiers)
+        {
+            ret_decl.type.simple_type = reuse_decl_specifiers->simple_type;
+            have_cpp_style_attrs = reuse_decl_specifiers->have_cpp_style_attrs;
+        }
+        else if (auto error = ParseAndAppendAttributeList(input, ret_decl.type.simple_type.attrs, ParseAttributeListFlags::before_decl, context, &have_cpp_style_attrs); error.message)
             return ret = error, ret;
 
 
@@ -1933,23 +2565,15 @@ namespace cppdecl
         // It's quite early, since we didn't parse the decl-specifier-seq yet, but parsing that can immediately emit
         //   a single member-pointer modifier, and that must be pushed to the stack rather than directly to the return type.
 
-        struct OpenParen
-        {
-            std::string_view input; // The remaining input starting with this `(`.
-            MaybeAmbiguousDecl ret_backup; // The backup of `ret_decl` at this position.
-        };
-
-        struct DeclaratorStackEntry
-        {
-            using Var = std::variant<OpenParen, Pointer, Reference, MemberPointer>;
-            Var var;
-
-            std::string_view location; // Copy of the input string right BEFORE this was parsed.
-        };
+        // We don't store a backup of `ret_decl` in `OpenParen`, because the declarators don't modify it until `ParseRemainingDecl()`,
+        //   so all parens share the same state, see `decl_checkpoint` below.
+        using detail::Parse::OpenParen;
+        using detail::Parse::DeclaratorStackEntry;
 
         // We don't normally pop from this (except when trying different parsing strategies to parse a function or something).
         // Instead we modify `declarator_stack_pos`.
-        std::vector<DeclaratorStackEntry> declarator_stack;
+        detail::Parse::PooledVector<DeclaratorStackEntry> declarator_stack_storage(context.scratch.declarator_stacks);
+        std::vector<DeclaratorStackEntry> &declarator_stack = declarator_stack_storage.vec;
 
 
         // We parse what looks like the variable name into this.
@@ -1964,7 +2588,7 @@ namespace cppdecl
         // Parse the decl-specifier-seq. This can also fill some extra data... (A single member pointer, or a declaration name.)
         // Note that `force_empty_return_type` shouldn't skip specifiers that are not a part of the return type,
         //   but we don't have any at the moment.
-        if (!force_empty_return_type)
+        if (!force_empty_return_type && !reuse_decl_specifiers)
         {
             while (true)
             {
@@ -1972,7 +2596,7 @@ namespace cppdecl
                 TrimLeadingWhitespace(input);
 
                 const auto input_before_parse = input;
-                ParseQualifiedNameResult result = ParseQualifiedName(input, ParseQualifiedNameFlags::only_valid_types | ParseQualifiedNameFlags::no_multiword_types);
+                ParseQualifiedNameResult result = ParseQualifiedName(input, ParseQualifiedNameFlags::only_valid_types | ParseQualifiedNameFlags::no_multiword_types, context);
                 if (auto error = std::get_if<ParseError>(&result))
                     return ret = *error, ret;
 
@@ -1993,10 +2617,16 @@ namespace cppdecl
                 if (name.IsEmpty())
                     break;
 
-                auto adding_name_result = TryAddNameToSimpleType(ret_decl.type.simple_type, name, {});
-                if (auto error = std::get_if<ParseError>(&adding_name_result))
-                    return ret = *error, input = input_before_parse, ret;
-                bool name_added = std::get<bool>(adding_name_result);
+                // If we know that this name isn't a type, don't add it to the type. Then this must be the declared name.
+                bool name_added = false;
+                if (context.IsKnownType(name) != false)
+                {
+                    // This only moves from `name` on success, so we can still use it below if it wasn't added.
+                    auto adding_name_result = TryAddNameToSimpleType(ret_decl.type.simple_type, std::move(name), {});
+                    if (auto error = std::get_if<ParseError>(&adding_name_result))
+                        return ret = *error, input = input_before_parse, ret;
+                    name_added = std::get<bool>(adding_name_result);
+                }
 
                 if (!name_added)
                 {
@@ -2023,14 +2653,20 @@ namespace cppdecl
 
 
                 // Any attributes after this part?
-                if (auto error = ParseAndAppendAttributeList(input, ret_decl.type.simple_type.attrs, ParseAttributeListFlags::in_simple_type); error.message)
+                if (auto error = ParseAndAppendAttributeList(input, ret_decl.type.simple_type.attrs, ParseAttributeListFlags::in_simple_type, context, &have_cpp_style_attrs); error.message)
                     return ret = error, ret;
             }
         }
 
         // Finalize the `SimpleType`.
-        if (auto error = FinalizeSimpleType(ret_decl.type.simple_type); error.message)
-            return ret = error, ret;
+        if (!reuse_decl_specifiers)
+        {
+            if (auto error = FinalizeSimpleType(ret_decl.type.simple_type); error.message)
+                return ret = error, ret;
+        }
+
+        if (out_decl_specifiers)
+            *out_decl_specifiers = {.simple_type = ret_decl.type.simple_type, .have_cpp_style_attrs = have_cpp_style_attrs};
 
         // Stop if we found a variable name after this.
         // We do this after adding the implicit `int` above.
@@ -2063,7 +2699,7 @@ namespace cppdecl
                 TrimLeadingWhitespace(input);
                 if (!left_side_only_and_no_parens && input.starts_with('('))
                 {
-                    declarator_stack.emplace_back(OpenParen{.input = input, .ret_backup = ret_decl}, input);
+                    declarator_stack.emplace_back(OpenParen{}, input);
                     input.remove_prefix(1);
                     have_any_parens_in_declarator_on_initial_parse = true;
                     continue;
@@ -2075,6 +2711,9 @@ namespace cppdecl
 
                     const std::string_view input_at_ptr = input;
 
+                    if (auto error = context.AddNodes(); error.message)
+                        return ret = error, ret;
+
                     input.remove_prefix(1);
                     Pointer ptr;
 
@@ -2093,6 +2732,9 @@ namespace cppdecl
 
                     const std::string_view input_at_ref = input;
 
+                    if (auto error = context.AddNodes(); error.message)
+                        return ret = error, ret;
+
                     Reference ref;
                     ref.kind = ParseRefQualifier(input);
 
@@ -2119,7 +2761,7 @@ namespace cppdecl
                 TrimLeadingWhitespace(input);
 
                 input_before_candidate_decl_name = input;
-                candidate_decl_name = ParseQualifiedName(input, ParseQualifiedNameFlags::allow_unqualified_destructors | ParseQualifiedNameFlags::only_valid_nontypes);
+                candidate_decl_name = ParseQualifiedName(input, ParseQualifiedNameFlags::allow_unqualified_destructors | ParseQualifiedNameFlags::only_valid_nontypes, context);
                 if (auto error = std::get_if<ParseError>(&candidate_decl_name))
                     return ret = *error, ret;
 
@@ -2200,7 +2842,17 @@ namespace cppdecl
                         else
                             return ParseError{.message = "Expected a qualified name but got an unqualified one."};
                     }
-                    return ret_decl; // Refuse to parse the rest, the declaration ends here. Not emit a hard error either, maybe it's just junk?
+                    return std::move(ret_decl); // Refuse to parse the rest, the declaration ends here. Not emit a hard error either, maybe it's just junk?
+                }
+
+                // If we know that this name is a type, it can't be the declared name, if it's in parentheses that could be a function parameter list,
+                //   such as `y` in `int(x(y))`. Then some other candidate uses it as a type.
+                // Otherwise the name can't be the type, so the types and the variables with the same name are fine, e.g. `struct stat stat` or `T T`.
+                // This doesn't apply to the empty return type, since the constructor names are types.
+                if (!force_empty_return_type && have_any_parens_in_declarator_on_initial_parse && bool(flags & ParseDeclFlags::accept_unnamed) && context.IsKnownType(name) == true)
+                {
+                    input = input_before_candidate_decl_name;
+                    return ParseError{.message = "Expected a name, but this is known to be a type."};
                 }
 
                 ret_decl.name = std::move(name);
@@ -2249,7 +2901,7 @@ namespace cppdecl
 
             // Complain if we have C++-style attributes but don't want them, either because the declaration is unnamed or because the flag `no_leading_cpp_style_attributes` was used.
             const bool no_cpp_attrs = bool(flags & ParseDeclFlags::no_leading_cpp_style_attributes);
-            if ((no_cpp_attrs || ret_decl.name.IsEmpty()) && std::any_of(ret_decl.type.simple_type.attrs.attrs.begin(), ret_decl.type.simple_type.attrs.attrs.end(), [](const Attribute &a){return a.style == Attribute::Style::cpp;}))
+            if ((no_cpp_attrs || ret_decl.name.IsEmpty()) && have_cpp_style_attrs)
             {
                 input = input_before_first_attr;
                 TrimLeadingWhitespace(input);
@@ -2266,6 +2918,10 @@ namespace cppdecl
 
             std::size_t declarator_stack_pos = declarator_stack.size();
 
+            // Everything on the stack except `(` becomes a modifier, and a `(` is usually followed by a function or array modifier
+            //   (as in `void (*)(int)`), so reserve right away.
+            ret_decl.type.modifiers.reserve(ret_decl.type.modifiers.size() + declarator_stack_pos);
+
             // Make sure we don't have empty `()` parentheses without a declarator between them.
             // I'm not sure if it's possible to trigger this at all without falling back to the function parameter list parsing.
             TrimLeadingWhitespace(input);
@@ -2351,7 +3007,7 @@ namespace cppdecl
                         while (!done)
                         {
                             if (declarator_stack_pos == 0)
-                                return ret_decl; // Extra `)` after input, but this is not an error. This is important e.g. for the last function parameter.
+                                return std::move(ret_decl); // Extra `)` after input, but this is not an error. This is important e.g. for the last function parameter.
 
                             std::optional<ParseError> error;
                             done = PopDeclaratorFromStack(error);
@@ -2394,10 +3050,13 @@ namespace cppdecl
                             return ParseError{.message = force_empty || (!force_non_empty && ret_decl.name.IsFunctionNameRequiringEmptyReturnType() == QualifiedName::EmptyReturnType::yes) ? "Assumed this was a function declaration with an empty return type, but found an array." : "Missing element type for the array."};
                         }
 
-                        auto expr_result = ParsePseudoExpr(input);
+                        auto expr_result = ParsePseudoExpr(input, {}, context);
                         if (auto error = std::get_if<ParseError>(&expr_result))
                             return *error;
 
+                        if (auto error = context.AddNodes(); error.message)
+                            return error;
+
                         Array arr;
                         arr.size = std::move(std::get<PseudoExpr>(expr_result));
 
@@ -2426,6 +3085,9 @@ namespace cppdecl
                             }
                         }
 
+                        if (auto error = context.AddNodes(); error.message)
+                            return error;
+
                         Function func;
 
                         TrimLeadingWhitespace(input);
@@ -2467,7 +3129,7 @@ namespace cppdecl
                                 {
                                     const auto input_before_param = input;
 
-                                    auto param_result = ParseDecl(input, ParseDeclFlags::accept_unnamed | ParseDeclFlags::accept_unqualified_named | ParseDeclFlags::force_non_empty_return_type | ParseDeclFlags::no_leading_cpp_style_attributes);
+                                    auto param_result = memo.ParseDecl(input, ParseDeclFlags::accept_unnamed | ParseDeclFlags::accept_unqualified_named | ParseDeclFlags::force_non_empty_return_type | ParseDeclFlags::no_leading_cpp_style_attributes, context);
                                     if (auto error = std::get_if<ParseError>(&param_result))
                                         return *error;
                                     MaybeAmbiguousDecl &param_decl = std::get<MaybeAmbiguousDecl>(param_result);
@@ -2568,7 +3230,7 @@ namespace cppdecl
 
                             const std::string_view input_before_type = input;
 
-                            auto ret_result = ParseType(input);
+                            auto ret_result = ParseType(input, {}, context);
                             if (auto error = std::get_if<ParseError>(&ret_result))
                                 return *error;
 
@@ -2665,10 +3327,10 @@ namespace cppdecl
             // But we don't seem to actually have any standard attributes that apply to TYPES as opposed to declarations, so for now I don't handle this.
             // Note that we decide to handle it, it must not be done here. We must do it after the function-parameter-list parsing.
 
-            if (auto error = ParseAndAppendAttributeList(input, ret_decl.type.simple_type.attrs, ParseAttributeListFlags::allow_gnu_style_attrs); error.message)
+            if (auto error = ParseAndAppendAttributeList(input, ret_decl.type.simple_type.attrs, ParseAttributeListFlags::allow_gnu_style_attrs, context); error.message)
                 return error;
 
-            return ret_decl;
+            return std::move(ret_decl);
         };
 
 
@@ -2676,16 +3338,14 @@ namespace cppdecl
         // Parses after the first one are never named anyway.
         // But there's another source of ambiguities, which is empty vs non-empty return type. Don't stop yet if that's a possibility.
         if (!bool(flags & ParseDeclFlags::accept_unnamed) && (!allow_empty_simple_type || force_empty_return_type))
+        {
+            context.CountStat(&ParseStats::candidates);
             return ParseRemainingDecl();
+        }
 
 
-        struct CandidateResult
-        {
-            ParseDeclResult ret;
-            std::string_view input; // The state of input after parsing.
-        };
-
-        std::vector<CandidateResult> candidates;
+        detail::Parse::PooledVector<detail::Parse::DeclCandidate> candidates_storage(context.scratch.decl_candidates);
+        std::vector<detail::Parse::DeclCandidate> &candidates = candidates_storage.vec;
 
         // If we haven't tries with an empty return type yet, try now.
         // This does before even the first primary candidate, because we prefer later candidates in the loop below,
@@ -2693,7 +3353,7 @@ namespace cppdecl
         if (allow_empty_simple_type && !force_empty_return_type && !ret_decl.type.simple_type.IsEmpty())
         {
             std::string_view input_copy = input_before_decl;
-            auto decl_result = ParseDecl(input_copy, flags | ParseDeclFlags::force_empty_return_type);
+            auto decl_result = memo.ParseDecl(input_copy, flags | ParseDeclFlags::force_empty_return_type, context);
 
             if (auto error = std::get_if<ParseError>(&decl_result))
             {
@@ -2720,35 +3380,64 @@ namespace cppdecl
         }
 
 
+        // If we do accept unnamed declarations, we'll check every preceding `(` as a possible function parameter list.
+        // `ParseRemainingDecl()` moves from `ret_decl`, so each retry needs to restore it first. The declarators don't modify `ret_decl`,
+        //   so every retry starts from the same state, and a single checkpoint is enough.
+        std::size_t num_retries = 0;
+        if (bool(flags & ParseDeclFlags::accept_unnamed))
+            num_retries = std::size_t(std::count_if(declarator_stack.begin(), declarator_stack.end(), [](const DeclaratorStackEntry &e){return std::holds_alternative<OpenParen>(e.var);}));
+
+        // Check the limit before doing the work. Everything except the main branch below counts as an extra interpretation.
+        if (auto error = context.AddAlternatives(candidates.size() + num_retries); error.message)
+        {
+            input = input_before_decl;
+            return ret = error, ret;
+        }
+
+        MaybeAmbiguousDecl decl_checkpoint;
+        if (num_retries > 0)
+        {
+            context.CountStat(&ParseStats::open_paren_backups);
+            decl_checkpoint = ret_decl;
+        }
+
+        // The candidates before this one have empty return types.
+        const std::size_t num_empty_return_type_candidates = candidates.size();
+
         // Now the main remaining parsing branch.
-        auto ret_backup = ret;
         candidates.emplace_back().ret = ParseRemainingDecl();
         candidates.back().input = input;
-        ret = std::move(ret_backup);
         candidate_decl_name = {}; // Reset the name. It's only meaningful during the initial parse. All retries will always be unnamed.
 
-        // If we do accept unnamed declarations, check every preceding `(` as a possible function parameter list.
-        if (bool(flags & ParseDeclFlags::accept_unnamed))
+        // Now the retries.
+        while (num_retries > 0)
         {
-            while (!declarator_stack.empty())
+            bool is_paren = std::holds_alternative<OpenParen>(declarator_stack.back().var);
+            if (is_paren)
             {
-                auto paren = std::get_if<OpenParen>(&declarator_stack.back().var);
-                if (paren)
+                context.CountStat(&ParseStats::backtracks);
+                input = declarator_stack.back().location;
+                // Don't need to copy for the last retry.
+                if (--num_retries == 0)
                 {
-                    input = paren->input;
-                    ret_decl = std::move(paren->ret_backup);
+                    ret_decl = std::move(decl_checkpoint);
                 }
-                declarator_stack.pop_back();
-                if (paren)
+                else
                 {
-                    ret_backup = ret;
-                    candidates.emplace_back().ret = ParseRemainingDecl();
-                    candidates.back().input = input;
-                    ret = std::move(ret_backup);
+                    context.CountStat(&ParseStats::open_paren_backups);
+                    ret_decl = decl_checkpoint;
                 }
             }
+            declarator_stack.pop_back();
+            if (is_paren)
+            {
+                candidates.emplace_back().ret = ParseRemainingDecl();
+                candidates.back().input = input;
+            }
         }
 
+        context.CountStat(&ParseStats::candidates, candidates.size());
+
         std::size_t candidate_index = 0;
 
         // If there's more than one candidate, pick the best one.
@@ -2763,7 +3452,7 @@ namespace cppdecl
             std::size_t min_unparsed_len = std::size_t(-1);
             bool have_successful_parse = false;
 
-            for (std::size_t i = 0; const CandidateResult &c : candidates)
+            for (std::size_t i = 0; const detail::Parse::DeclCandidate &c : candidates)
             {
                 // Assert that `.ambiguous_alternative` is null. It shouldn't be set at this point.
                 assert([&]{
@@ -2806,6 +3495,10 @@ namespace cppdecl
             }
         }
 
+        // If we've chosen an empty return type, the decl-specifier-seq is empty.
+        if (out_decl_specifiers && candidate_index < num_empty_return_type_candidates)
+            *out_decl_specifiers = {};
+
         // Return the selected candidate.
         ret = std::move(candidates[candidate_index].ret);
         // Restore the parse state for that candidate too.
@@ -2813,17 +3506,228 @@ namespace cppdecl
         return ret;
     }
 
+    CPPDECL_CONSTEXPR ParseDeclResult detail::Parse::DeclMemo::ParseDecl(std::string_view &input, ParseDeclFlags flags, ParseContext &context)
+    {
+        context.CountStat(&ParseStats::decl_reentries);
+
+        ReserveSlot();
+        std::size_t &slot = FindSlot(input, flags);
+
+        // First time, just remember the call.
+        if (slot == 0)
+        {
+            DeclMemoEntry &entry = entries.emplace_back();
+            entry.input_begin = input.data();
+            entry.input_size = input.size();
+            entry.flags = flags;
+            slot = entries.size();
+            return cppdecl::ParseDecl(input, flags, context, *this);
+        }
+
+        // Note that `slots` can be rehashed during the call below, so we don't keep a reference to `slot`.
+        const std::size_t i = slot - 1;
+
+        // Second time, remember the result. Note that `entries` can be reallocated during the call, so we don't keep a reference.
+        if (!entries[i].result)
+        {
+            ParseDeclResult ret = cppdecl::ParseDecl(input, flags, context, *this);
+            entries[i].result = ret;
+            entries[i].input_after = input;
+            if (auto decl = std::get_if<MaybeAmbiguousDecl>(&ret))
+            {
+                const Measurement m = cppdecl::Measure(*decl);
+                entries[i].num_nodes = m.num_nodes;
+                entries[i].num_alternatives = m.num_alternatives;
+            }
+            return ret;
+        }
+
+        context.CountStat(&ParseStats::decl_memo_hits);
+        if (auto error = context.AddNodes(entries[i].num_nodes); error.message)
+            return error;
+        if (auto error = context.AddAlternatives(entries[i].num_alternatives); error.message)
+            return error;
+        input = entries[i].input_after;
+        return *entries[i].result;
+    }
+
+    using ParseDeclListResult = std::variant<DeclList, ParseError>;
+
+    // Parses a declaration of one or more entities, such as `int a, *b, c[3]`. Returns `ParseError` on failure.
+    // The decl-specifier-seq is parsed only once and is stored once in the result, see `DeclList` for details.
+    // `flags` are the same as in `ParseDecl()`, and apply to each declarator. Stops at the first token that can't continue the list.
+    [[nodiscard]] CPPDECL_CONSTEXPR ParseDeclListResult ParseDeclList(std::string_view &input, ParseDeclFlags flags, ParseContext &context)
+    {
+        ParseDeclListResult ret;
+        DeclList &ret_list = std::get<DeclList>(ret);
+
+        detail::Parse::TopLevelGuard top_level_guard(context);
+        detail::Parse::DeclMemo memo(context);
+
+        // The first declaration, this also parses the decl-specifier-seq.
+        detail::Parse::SharedDeclSpecifiers decl_specifiers;
+        ParseDeclResult first_result = ParseDecl(input, flags, context, memo, nullptr, &decl_specifiers);
+        if (context.limit_error.message)
+            return ret = context.limit_error, ret;
+        if (auto error = std::get_if<ParseError>(&first_result))
+            return ret = *error, ret;
+
+        // If the declarator didn't change the decl-specifier-seq (which is the usual case), don't store it the second time.
+        auto AddDecl = [&](MaybeAmbiguousDecl &&decl)
+        {
+            if (decl.type.simple_type == decl_specifiers.simple_type)
+                decl.type.simple_type = {};
+            ret_list.decls.push_back(std::move(decl));
+        };
+
+        AddDecl(std::move(std::get<MaybeAmbiguousDecl>(first_result)));
+
+        // If the decl-specifier-seq is empty (constructors and such), all declarators must have empty return types too.
+        const ParseDeclFlags next_flags = flags | (decl_specifiers.simple_type.IsEmpty() ? ParseDeclFlags::force_empty_return_type : ParseDeclFlags::force_non_empty_return_type);
+
+        while (true)
+        {
+            TrimLeadingWhitespace(input);
+            const std::string_view input_before_comma = input;
+            if (!ConsumePunctuation(input, ","))
+                break;
+
+            TrimLeadingWhitespace(input);
+            const std::string_view input_before_declarator = input;
+
+            ParseDeclResult result = ParseDecl(input, next_flags, context, memo, decl_specifiers.simple_type.IsEmpty() ? nullptr : &decl_specifiers);
+            if (context.limit_error.message)
+                return ret = context.limit_error, ret;
+            if (auto error = std::get_if<ParseError>(&result))
+                return ret = *error, ret;
+
+            // An unnamed declaration would happily consume nothing here.
+            if (input.data() == input_before_declarator.data())
+            {
+                input = input_before_comma;
+                return ret = ParseError{.message = "Expected a declarator after `,`."}, ret;
+            }
+
+            AddDecl(std::move(std::get<MaybeAmbiguousDecl>(result)));
+        }
+
+        ret_list.simple_type = std::move(decl_specifiers.simple_type);
+        return ret;
+    }
+    [[nodiscard]] CPPDECL_CONSTEXPR ParseDeclListResult ParseDeclList(std::string_view &input, ParseDeclFlags flags)
+    {
+        ParseContext context;
+        return ParseDeclList(input, flags, context);
+    }
+
+    namespace detail::Parse
+    {
+        // The fast path for `ParseType()`, for the most common kind of types: a simple type followed by some pointers and at most one reference,
+        //   e.g. `const std::vector<int> *const &`. This skips the declarator stack and the candidates of `ParseDecl()`.
+        // Returns null if the input isn't of this form (e.g. if we see `(`, `[`, or attributes), then the caller should fall back to `ParseDecl()`.
+        // We also return null on errors, to let `ParseDecl()` produce the usual error messages.
+        // On success, the result and the remaining input are exactly the same as what `ParseDecl()` would produce.
+        // This also returns null if any of the `context.limits` are exceeded, then `ParseDecl()` will report that.
+        [[nodiscard]] CPPDECL_CONSTEXPR std::optional<Type> ParseTypeFast(std::string_view &input, ParseContext &context)
+        {
+            std::optional<Type> ret;
+
+            // This counts as the same nesting level as `ParseDecl()`. We only call it after this fails.
+            NestingGuard guard(context);
+            if (guard.error.message)
+                return ret;
+
+            std::string_view s = input;
+
+            // This uses the same logic as the decl-specifier-seq in `ParseDecl()`.
+            auto simple_type_result = ParseSimpleType(s, {}, context);
+            if (!std::holds_alternative<SimpleType>(simple_type_result))
+                return ret;
+            SimpleType &simple_type = std::get<SimpleType>(simple_type_result);
+            // `ParseDecl()` parses the leading attributes with different flags, so let it handle them.
+            if (simple_type.IsEmpty() || !simple_type.attrs.attrs.empty())
+                return ret;
+            // If the `ParseContext::type_oracle` says this isn't a type, `ParseDecl()` will refuse to add it to the type. Let it do that.
+            if (context.IsKnownType(simple_type.name) == false)
+                return ret;
+
+            Type &ret_type = ret.emplace();
+            ret_type.simple_type = std::move(simple_type);
+
+            // The declarators. They are stored in the reverse order.
+            while (true)
+            {
+                TrimLeadingWhitespace(s);
+
+                // A reference must be the last declarator. Otherwise it's an error, or something we don't handle here.
+                if (!ret_type.modifiers.empty() && std::holds_alternative<Reference>(ret_type.modifiers.back().var))
+                    break;
+
+                if (ConsumePunctuation(s, "*"))
+                {
+                    if (context.AddNodes().message)
+                        return ret.reset(), ret;
+                    auto quals = ParseCvQualifiers(s);
+                    if (!std::holds_alternative<CvQualifiers>(quals))
+                        return ret.reset(), ret;
+                    Pointer ptr;
+                    ptr.quals = std::get<CvQualifiers>(quals);
+                    ret_type.modifiers.push_back({.var = std::move(ptr)});
+                }
+                else if (s.starts_with('&'))
+                {
+                    if (context.AddNodes().message)
+                        return ret.reset(), ret;
+                    RefQualifier kind = ParseRefQualifier(s);
+                    auto quals = ParseCvQualifiers(s);
+                    // Cv-qualified references are errors.
+                    if (!std::holds_alternative<CvQualifiers>(quals) || std::get<CvQualifiers>(quals) != CvQualifiers{})
+                        return ret.reset(), ret;
+                    Reference ref;
+                    ref.kind = kind;
+                    ret_type.modifiers.push_back({.var = std::move(ref)});
+                }
+                else
+                {
+                    break;
+                }
+            }
+
+            // Only accept if this is followed by something that ends the type anyway.
+            // Everything else (names, parentheses, brackets, attributes, member pointers, etc) goes to the general parser.
+            if (!s.empty() && s.front() != ',' && s.front() != '>' && s.front() != ')')
+                return ret.reset(), ret;
+
+            std::reverse(ret_type.modifiers.begin(), ret_type.modifiers.end());
+            input = s;
+            return ret;
+        }
+    }
+
     // A subset of `ParseDecl()` that rejects named declarations.
     // My current understanding is that rejecting names makes this never ambiguous, so we return only one type. There's an assert for that.
-    [[nodiscard]] CPPDECL_CONSTEXPR ParseTypeResult ParseType(std::string_view &input, ParseTypeFlags flags)
+    [[nodiscard]] CPPDECL_CONSTEXPR ParseTypeResult ParseType(std::string_view &input, ParseTypeFlags flags, ParseContext &context)
     {
         ParseTypeResult ret;
 
+        detail::Parse::TopLevelGuard top_level_guard(context);
+
+        // Try the fast path first.
+        if (!bool(flags & (ParseTypeFlags::only_left_side_declarators_without_parens | ParseTypeFlags::no_fast_path)))
+        {
+            if (auto type = detail::Parse::ParseTypeFast(input, context); type && !context.limit_error.message)
+            {
+                ret = std::move(*type);
+                return ret; // Not `return ret = ..., ret;`, since that would copy instead of moving.
+            }
+            context.CountStat(&ParseStats::backtracks);
+        }
+
         ParseDeclFlags decl_flags = ParseDeclFlags::accept_unnamed | ParseDeclFlags::no_leading_cpp_style_attributes;
         if (bool(flags & ParseTypeFlags::only_left_side_declarators_without_parens))
             decl_flags |= ParseDeclFlags::accept_unnamed_only_left_side_declarators_without_parens;
 
-        ParseDeclResult decl_result = ParseDecl(input, decl_flags);
+        ParseDeclResult decl_result = ParseDecl(input, decl_flags, context);
         if (auto error = std::get_if<ParseError>(&decl_result))
             return ret = *error, ret;
 
@@ -2839,7 +3743,7 @@ namespace cppdecl
 
     // Parses a template argument list.
     // Returns null only if `input` (after skipping whitespace) doesn't start with `<`.
-    [[nodiscard]] CPPDECL_CONSTEXPR ParseTemplateArgumentListResult ParseTemplateArgumentList(std::string_view &input)
+    [[nodiscard]] CPPDECL_CONSTEXPR ParseTemplateArgumentListResult ParseTemplateArgumentList(std::string_view &input, ParseContext &context)
     {
         ParseTemplateArgumentListResult ret;
 
@@ -2850,20 +3754,40 @@ namespace cppdecl
         if (input.starts_with("<<") || !ConsumePunctuation(input, "<"))
             return ret; // No argument list here, return nullopt.
 
+        detail::Parse::NestingGuard guard(context);
+        if (guard.error.message)
+            return input = input_before_list, ret = guard.error, ret;
+
         TemplateArgumentList &ret_list = std::get<std::optional<TemplateArgumentList>>(ret).emplace();
 
         TrimLeadingWhitespace(input);
 
         if (!ConsumePunctuation(input, ">"))
         {
+            // Don't parse the arguments now, if requested.
+            // If the brackets don't look balanced, we fall back to the normal parsing, which reports the error properly.
+            if (context.lazy_template_args)
+            {
+                std::string_view s = input_before_list;
+                if (detail::Parse::ConsumeBalancedBrackets(s))
+                {
+                    ret_list.unparsed = input_before_list.substr(0, std::size_t(s.data() - input_before_list.data()));
+                    input = s;
+                    return ret;
+                }
+            }
+
             while (true)
             {
+                if (context.limits.max_template_args != 0 && ret_list.args.size() >= context.limits.max_template_args)
+                    return ret = context.ExceedLimit("Exceeded the maximum number of template arguments."), ret;
+
                 TemplateArgument new_arg;
 
                 // Try a declaration (unnamed).
                 bool decl_ok = false;
                 const std::string_view input_before_arg = input;
-                auto type_result = ParseType(input);
+                auto type_result = ParseType(input, {}, context);
                 if (auto type = std::get_if<Type>(&type_result))
                 {
                     TrimLeadingWhitespace(input);
@@ -2877,8 +3801,10 @@ namespace cppdecl
 
                 if (!decl_ok)
                 {
+                    context.CountStat(&ParseStats::backtracks);
+                    context.CountStat(&ParseStats::pseudo_expr_fallbacks);
                     input = input_before_arg;
-                    auto expr_result = ParsePseudoExpr(input, ParsePseudoExprFlags::stop_on_gt_sign);
+                    auto expr_result = ParsePseudoExpr(input, ParsePseudoExprFlags::stop_on_gt_sign, context);
                     if (auto error = std::get_if<ParseError>(&expr_result))
                         return ret = *error, ret; // This is fatal.
 
@@ -2895,7 +3821,13 @@ namespace cppdecl
                 if (ConsumePunctuation(input, ">"))
                     break;
                 if (ConsumePunctuation(input, ","))
+                {
+                    // Lists with more than one argument usually have 2-4 of them (think standard containers). Reserve to avoid reallocating on every argument.
+                    if (ret_list.args.size() == 1)
+                        ret_list.args.reserve(4);
+
                     continue;
+                }
 
                 if (input.empty())
                     return input = input_before_list, ret = ParseError{.message = "Unterminated template argument list."}, ret;
@@ -2907,4 +3839,72 @@ namespace cppdecl
 
         return ret;
     }
+
+    // Parses `list.unparsed` (see `ParseContext::lazy_template_args`) into `list.args`, and clears `list.unparsed`.
+    // Does nothing if the list was already parsed. On failure returns the error and leaves `list` unchanged, otherwise returns a null message.
+    // Pass the same `context` as when parsing lazily, to apply the same limits and the same `type_oracle`. Note that the depth is counted from the list itself.
+    // The arguments are parsed eagerly, even if `context.lazy_template_args` is set.
+    [[nodiscard]] CPPDECL_CONSTEXPR ParseError MaterializeTemplateArgs(TemplateArgumentList &list, ParseContext &context)
+    {
+        if (!list.IsLazy())
+            return {};
+
+        detail::Parse::TopLevelGuard top_level_guard(context);
+
+        const bool was_lazy = context.lazy_template_args;
+        context.lazy_template_args = false;
+        std::string_view input = list.unparsed;
+        auto result = ParseTemplateArgumentList(input, context);
+        context.lazy_template_args = was_lazy;
+
+        if (context.limit_error.message)
+            return context.limit_error;
+        if (auto error = std::get_if<ParseError>(&result))
+            return *error;
+
+        // `unparsed` always ends with `>`, so this shouldn't leave anything behind.
+        if (!input.empty())
+            return ParseError{.message = "Unparsed junk after the template argument list."};
+
+        list.args = std::move(std::get<std::optional<TemplateArgumentList>>(result)->args);
+        list.unparsed.clear();
+        return {};
+    }
+    [[nodiscard]] CPPDECL_CONSTEXPR ParseError MaterializeTemplateArgs(TemplateArgumentList &list)
+    {
+        ParseContext context;
+        return MaterializeTemplateArgs(list, context);
+    }
+
+    // Materializes all lazy template argument lists in `target` (a `Type`, `Decl`, `QualifiedName`, etc).
+    // The arguments are parsed eagerly, so nothing nested in them stays lazy.
+    // Stops on the first failure and returns the error. On success returns a null message.
+    template <typename T> requires(!std::same_as<T, TemplateArgumentList>)
+    [[nodiscard]] CPPDECL_CONSTEXPR ParseError MaterializeTemplateArgs(T &target, ParseContext &context)
+    {
+        ParseError ret;
+        detail::Parse::TopLevelGuard top_level_guard(context);
+        (void)target.template VisitEachComponent<TemplateArgumentList>({}, [&](TemplateArgumentList &list)
+        {
+            ret = MaterializeTemplateArgs(list, context);
+            return ret.message ? VisitResult::stop : VisitResult::recurse;
+        });
+        return ret;
+    }
+    template <typename T> requires(!std::same_as<T, TemplateArgumentList>)
+    [[nodiscard]] CPPDECL_CONSTEXPR ParseError MaterializeTemplateArgs(T &target)
+    {
+        ParseContext context;
+        return MaterializeTemplateArgs(target, context);
+    }
+
+    namespace detail::TemplateArgs
+    {
+        // Declared in `data.h`.
+        template <typename L>
+        CPPDECL_CONSTEXPR bool Materialize(L &list)
+        {
+            return !MaterializeTemplateArgs(list).message;
+        }
+    }
 }
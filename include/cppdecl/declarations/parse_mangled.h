@@ -0,0 +1,1165 @@
+#pragma once
+
+#include "cppdecl/declarations/data.h"
+#include "cppdecl/declarations/parse.h"
+#include "cppdecl/misc/platform.h"
+#include "cppdecl/misc/string_helpers.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// Parsing types directly from the mangled names, without demangling them to strings first.
+// The Itanium parser is what `TypeNameDynamic()` uses on GCC and Clang, falling back to the demangler for the constructs that we don't support.
+
+namespace cppdecl
+{
+    // Parses an Itanium-mangled type name, as returned by `typeid(T).name()` on GCC and Clang (on all platforms except Windows with the MSVC ABI).
+    // The result is the same as what you get by demangling the name with `abi::__cxa_demangle()` and then parsing it with `ParseType()`,
+    //   but this is a single pass over the input, and doesn't need the demangler at all.
+    // We only support the part of the grammar that `typeid(...).name()` can produce, and not all of that either (e.g. no local types, lambdas,
+    //   or non-type template arguments other than integers and booleans). On those we return an error, then you should fall back to the demangler.
+    // Like the other parsing functions, on failure `input` points to the error, and on success it contains the unparsed suffix, if any.
+    [[nodiscard]] CPPDECL_CONSTEXPR ParseTypeResult ParseItaniumMangledType(std::string_view &input);
+
+    // Parses an MSVC-decorated type name, as returned by `typeid(T).raw_name()` on MSVC, e.g. `.?AV?$vector@HV?$allocator@H@std@@@std@@`.
+    // The leading `.` is optional. This is platform-independent, so it can be used to process the names collected from Windows builds elsewhere.
+    // The result is the same as what you get by parsing the undecorated name (`typeid(T).name()`) with `ParseType()`,
+    //   except that `__int64` becomes `long long`, since we can't parse `unsigned __int64` otherwise.
+    // We only support the common subset of the grammar: classes (and structs, unions, enums), templates with type and integer arguments,
+    //   built-in types, pointers, references, arrays, and cv-qualifiers. Notably no function types and no member pointers.
+    // On failure `input` points to the error, and on success it contains the unparsed suffix, if any.
+    [[nodiscard]] CPPDECL_CONSTEXPR ParseTypeResult ParseMsvcDecoratedType(std::string_view &input);
+
+
+    namespace detail::ParseMangled
+    {
+        // A substitution candidate.
+        struct Substitution
+        {
+            // The mangled text of this candidate. We parse it again when the candidate is used.
+            // This works because the substitutions nested in it can only refer to the earlier candidates.
+            std::string_view mangled;
+
+            // If true, this is a prefix of a nested name (the part after `N`, without the closing `E`). Otherwise this is a type.
+            bool is_nested_name_prefix = false;
+        };
+
+        // The state shared by the entire mangled name.
+        struct State
+        {
+            // The substitution candidates, in the order they are numbered in: `S_`, `S0_`, `S1_`, etc.
+            // We don't store the parsed candidates, since copying them is expensive, and most of them are never used.
+            std::vector<Substitution> substitutions;
+
+            // Non-zero while we're parsing a substitution again. Then we must not add new candidates.
+            int replay_depth = 0;
+
+            // Adds a candidate from `begin` to the start of `input`.
+            CPPDECL_CONSTEXPR void AddSubstitution(const char *begin, std::string_view input, bool is_nested_name_prefix)
+            {
+                if (replay_depth == 0)
+                {
+                    Substitution &sub = substitutions.emplace_back();
+                    sub.mangled = std::string_view(begin, std::size_t(input.data() - begin));
+                    sub.is_nested_name_prefix = is_nested_name_prefix;
+                }
+            }
+        };
+
+        [[nodiscard]] CPPDECL_CONSTEXPR ParseError ParseType(std::string_view &input, State &state, Type &out);
+        [[nodiscard]] CPPDECL_CONSTEXPR ParseError ParseNestedNamePrefix(std::string_view &input, State &state, Type &out);
+
+        // If `input` starts with a built-in type, returns its name (without signedness) and sets `flags` and `mangled_length` (the length of the mangled form).
+        // Otherwise returns empty. We don't support all built-in types, only the common ones.
+        // This must match what `ParseSimpleType()` produces for the same types, which is tested.
+        [[nodiscard]] CPPDECL_CONSTEXPR std::string_view BuiltInTypeName(std::string_view input, SimpleTypeFlags &flags, std::size_t &mangled_length)
+        {
+            flags = {};
+            mangled_length = 1;
+            switch (input.empty() ? '\0' : input.front())
+            {
+                case 'v': return "void";
+                case 'w': return "wchar_t";
+                case 'b': return "bool";
+                case 'c': return "char";
+                case 'a': flags = SimpleTypeFlags::explicitly_signed; return "char";
+                case 'h': flags = SimpleTypeFlags::unsigned_; return "char";
+                case 's': return "short";
+                case 't': flags = SimpleTypeFlags::unsigned_; return "short";
+                case 'i': return "int";
+                case 'j': flags = SimpleTypeFlags::unsigned_; return "int";
+                case 'l': return "long";
+                case 'm': flags = SimpleTypeFlags::unsigned_; return "long";
+                case 'x': return "long long";
+                case 'y': flags = SimpleTypeFlags::unsigned_; return "long long";
+                case 'n': return "__int128";
+                case 'o': flags = SimpleTypeFlags::unsigned_; return "__int128";
+                case 'f': return "float";
+                case 'd': return "double";
+                case 'e': return "long double";
+                case 'g': return "__float128";
+              case 'D':
+                mangled_length = 2;
+                switch (input.size() < 2 ? '\0' : input[1])
+                {
+                    case 'i': return "char32_t";
+                    case 's': return "char16_t";
+                    case 'u': return "char8_t";
+                }
+                break;
+            }
+            return {};
+        }
+
+        // Parses a `<source-name>`, which is a length followed by that many characters.
+        [[nodiscard]] CPPDECL_CONSTEXPR ParseError ParseSourceName(std::string_view &input, UnqualifiedName &out)
+        {
+            std::size_t length = 0;
+            std::size_t i = 0;
+            while (i < input.size() && IsDigit(input[i]))
+            {
+                length = length * 10 + std::size_t(input[i] - '0');
+                i++;
+                if (length > input.size())
+                    return {.message = "The length of the name is larger than the rest of the input."};
+            }
+            if (i == 0)
+                return {.message = "Expected the length of the name."};
+            if (length == 0 || length > input.size() - i)
+                return {.message = "The length of the name is invalid."};
+
+            std::string_view word = input.substr(i, length);
+            // The anonymous namespaces are mangled as `_GLOBAL__N_1`, or with some other suffix.
+            if (word.starts_with("_GLOBAL__N"))
+                out.var = UnspellableName{.name = "(anonymous namespace)"};
+            else
+                out.var = std::string(word);
+
+            input.remove_prefix(i + length);
+            return {};
+        }
+
+        // Parses `S_` or `S<base-36 number>_`, after the `S` was already consumed. Writes the substitution index to `index`.
+        [[nodiscard]] CPPDECL_CONSTEXPR ParseError ParseSubstitutionIndex(std::string_view &input, const State &state, std::size_t &index)
+        {
+            index = 0;
+            if (!input.starts_with('_'))
+            {
+                while (!input.empty() && input.front() != '_')
+                {
+                    char ch = input.front();
+                    std::size_t digit = 0;
+                    if (IsDigit(ch))
+                        digit = std::size_t(ch - '0');
+                    else if (ch >= 'A' && ch <= 'Z')
+                        digit = std::size_t(ch - 'A' + 10);
+                    else
+                        return {.message = "Unsupported substitution."};
+
+                    index = index * 36 + digit;
+                    if (index >= state.substitutions.size())
+                        return {.message = "The substitution index is out of range."};
+                    input.remove_prefix(1);
+                }
+                index++;
+            }
+
+            if (!input.starts_with('_') || index >= state.substitutions.size())
+                return {.message = "Invalid substitution."};
+            input.remove_prefix(1);
+            return {};
+        }
+
+        // Parses `S...` that's either a substitution or one of the special abbreviations (but not `St`).
+        // Only sets `out.simple_type.name` for the abbreviations.
+        // For `Ss` and the like, which can't be followed by template arguments, sets `is_complete_type`.
+        [[nodiscard]] CPPDECL_CONSTEXPR ParseError ParseSubstitutionOrAbbreviation(std::string_view &input, State &state, Type &out, bool &is_complete_type)
+        {
+            is_complete_type = false;
+
+            if (!input.starts_with('S'))
+                return {.message = "Expected a substitution."};
+
+            auto Abbreviation = [&](std::string_view name, bool complete)
+            {
+                input.remove_prefix(2);
+                out = {};
+                out.simple_type.name.parts.emplace_back().var = std::string("std");
+                out.simple_type.name.parts.emplace_back().var = std::string(name);
+                is_complete_type = complete;
+            };
+
+            switch (input.size() < 2 ? '\0' : input[1])
+            {
+                case 'a': Abbreviation("allocator", false); return {};
+                case 'b': Abbreviation("basic_string", false); return {};
+                case 's': Abbreviation("string", true); return {};
+                case 'i': Abbreviation("istream", true); return {};
+                case 'o': Abbreviation("ostream", true); return {};
+                case 'd': Abbreviation("iostream", true); return {};
+            }
+
+            input.remove_prefix(1);
+            std::size_t index = 0;
+            if (ParseError error = ParseSubstitutionIndex(input, state, index); error.message)
+                return error;
+
+            // Parse the candidate again.
+            const Substitution sub = state.substitutions[index];
+            std::string_view mangled = sub.mangled;
+            state.replay_depth++;
+            ParseError error = sub.is_nested_name_prefix ? ParseNestedNamePrefix(mangled, state, out) : ParseType(mangled, state, out);
+            state.replay_depth--;
+            if (!error.message && !mangled.empty())
+                error.message = "Unable to parse a substitution."; // This shouldn't happen.
+            return error;
+        }
+
+        // Parses an `L...E` literal in a template argument list, after `L` was already consumed.
+        // We only support integers and booleans.
+        [[nodiscard]] CPPDECL_CONSTEXPR ParseError ParseLiteral(std::string_view &input, TemplateArgumentList &out)
+        {
+            // This is how the demangler spells the suffixes.
+            std::string_view suffix;
+            bool is_bool = false;
+            switch (input.empty() ? '\0' : input.front())
+            {
+                case 'i': break;
+                case 'j': suffix = "u"; break;
+                case 'l': suffix = "l"; break;
+                case 'm': suffix = "ul"; break;
+                case 'x': suffix = "ll"; break;
+                case 'y': suffix = "ull"; break;
+                case 'b': is_bool = true; break;
+              default:
+                return {.message = "Unsupported type of a literal template argument."};
+            }
+            input.remove_prefix(1);
+
+            bool negative = input.starts_with('n');
+            if (negative)
+                input.remove_prefix(1);
+
+            std::size_t num_digits = 0;
+            while (num_digits < input.size() && IsDigit(input[num_digits]))
+                num_digits++;
+            if (num_digits == 0)
+                return {.message = "Expected the value of the literal."};
+            std::string_view digits = input.substr(0, num_digits);
+
+            if (num_digits >= input.size() || input[num_digits] != 'E')
+            {
+                input.remove_prefix(num_digits);
+                return {.message = "Expected `E` after the literal."};
+            }
+
+            std::string text = "<";
+            if (is_bool)
+            {
+                if (negative || (digits != "0" && digits != "1"))
+                    return {.message = "Invalid boolean literal."};
+                text += digits == "1" ? "true" : "false";
+            }
+            else
+            {
+                if (negative)
+                    text += '-';
+                text += digits;
+                text += suffix;
+            }
+            text += '>';
+
+            // Reuse the usual parser, to make sure we end up with the same tokens as if we parsed the demangled name.
+            std::string_view text_view = text;
+            auto result = cppdecl::ParseTemplateArgumentList(text_view);
+            auto list = std::get_if<std::optional<TemplateArgumentList>>(&result);
+            if (!list || !*list || (*list)->args.size() != 1 || !text_view.empty())
+                return {.message = "Unable to parse the literal."};
+
+            out.args.push_back(std::move((*list)->args.front()));
+            input.remove_prefix(num_digits + 1);
+            return {};
+        }
+
+        // Parses a template argument, appending it to `out`. Argument packs are expanded.
+        [[nodiscard]] CPPDECL_CONSTEXPR ParseError ParseTemplateArgument(std::string_view &input, State &state, TemplateArgumentList &out)
+        {
+            if (input.starts_with('L'))
+            {
+                input.remove_prefix(1);
+                return ParseLiteral(input, out);
+            }
+
+            if (input.starts_with('J'))
+            {
+                input.remove_prefix(1);
+                while (!input.starts_with('E'))
+                {
+                    if (input.empty())
+                        return {.message = "Expected `E` to close the argument pack."};
+                    if (ParseError error = ParseTemplateArgument(input, state, out); error.message)
+                        return error;
+                }
+                input.remove_prefix(1);
+                return {};
+            }
+
+            if (input.starts_with('X'))
+                return {.message = "Expressions in template arguments are not supported."};
+
+            Type type;
+            if (ParseError error = ParseType(input, state, type); error.message)
+                return error;
+            out.args.push_back({.var = std::move(type)});
+            return {};
+        }
+
+        // Parses `I...E`.
+        [[nodiscard]] CPPDECL_CONSTEXPR ParseError ParseTemplateArgs(std::string_view &input, State &state, UnqualifiedName &out)
+        {
+            if (!input.starts_with('I'))
+                return {.message = "Expected `I` to start the template argument list."};
+            input.remove_prefix(1);
+
+            TemplateArgumentList &list = out.template_args.emplace();
+            while (!input.starts_with('E'))
+            {
+                if (input.empty())
+                    return {.message = "Expected `E` to close the template argument list."};
+                if (ParseError error = ParseTemplateArgument(input, state, list); error.message)
+                    return error;
+            }
+            input.remove_prefix(1);
+            return {};
+        }
+
+        // If `input` starts with a template argument list, parses it into the last part of the name in `out`,
+        //   and adds the resulting name to the substitutions. `begin` and `is_nested_name_prefix` are passed to `State::AddSubstitution()`.
+        [[nodiscard]] CPPDECL_CONSTEXPR ParseError ParseTemplateArgumentListIfAny(std::string_view &input, State &state, Type &out, const char *begin, bool is_nested_name_prefix)
+        {
+            if (!input.starts_with('I'))
+                return {};
+            if (out.simple_type.name.parts.empty() || out.simple_type.name.parts.back().template_args || !out.modifiers.empty() || out.simple_type.quals != CvQualifiers{})
+                return {.message = "Template arguments are applied to something that isn't a template."};
+            if (ParseError error = ParseTemplateArgs(input, state, out.simple_type.name.parts.back()); error.message)
+                return error;
+            state.AddSubstitution(begin, input, is_nested_name_prefix);
+            return {};
+        }
+
+        // Parses the contents of `N...E` without the `E`, stopping at `E` or at the end of input.
+        [[nodiscard]] CPPDECL_CONSTEXPR ParseError ParseNestedNamePrefix(std::string_view &input, State &state, Type &out)
+        {
+            out = {};
+
+            const char *begin = input.data();
+
+            if (input.starts_with("St"))
+            {
+                // `std::` itself isn't a substitution candidate.
+                input.remove_prefix(2);
+                out.simple_type.name.parts.emplace_back().var = std::string("std");
+            }
+            else if (input.starts_with('S'))
+            {
+                bool is_complete_type = false;
+                if (ParseError error = ParseSubstitutionOrAbbreviation(input, state, out, is_complete_type); error.message)
+                    return error;
+                if (is_complete_type || !out.modifiers.empty() || out.simple_type.quals != CvQualifiers{})
+                    return {.message = "This substitution can't be used as a prefix of a nested name."};
+            }
+
+            while (!input.empty() && input.front() != 'E')
+            {
+                if (input.front() == 'I')
+                {
+                    if (ParseError error = ParseTemplateArgumentListIfAny(input, state, out, begin, true); error.message)
+                        return error;
+                    continue;
+                }
+
+                if (!IsDigit(input.front()))
+                    return {.message = "Unsupported component of a nested name."};
+
+                if (ParseError error = ParseSourceName(input, out.simple_type.name.parts.emplace_back()); error.message)
+                    return error;
+                // Each prefix is a substitution candidate, including the whole name.
+                state.AddSubstitution(begin, input, true);
+            }
+
+            if (out.simple_type.name.parts.empty())
+                return {.message = "Empty nested name."};
+            return {};
+        }
+
+        // Parses `N...E`, after `N` was already consumed.
+        [[nodiscard]] CPPDECL_CONSTEXPR ParseError ParseNestedName(std::string_view &input, State &state, Type &out)
+        {
+            // Those only appear in the names of member functions, not in types.
+            if (!input.empty() && (input.front() == 'K' || input.front() == 'V' || input.front() == 'r' || input.front() == 'R' || input.front() == 'O'))
+                return {.message = "Qualifiers on nested names are not supported."};
+
+            if (ParseError error = ParseNestedNamePrefix(input, state, out); error.message)
+                return error;
+
+            if (!input.starts_with('E'))
+                return {.message = "Expected `E` to close the nested name."};
+            input.remove_prefix(1);
+            return {};
+        }
+
+        // Parses `F...E`, after `F` was already consumed.
+        [[nodiscard]] CPPDECL_CONSTEXPR ParseError ParseFunctionType(std::string_view &input, State &state, Type &out)
+        {
+            // `extern "C"`. The demangler doesn't print it.
+            if (input.starts_with('Y'))
+                input.remove_prefix(1);
+
+            if (ParseError error = ParseType(input, state, out); error.message)
+                return error;
+
+            Function func;
+
+            while (true)
+            {
+                if (input.starts_with('E'))
+                {
+                    input.remove_prefix(1);
+                    break;
+                }
+                if (input.starts_with("RE") || input.starts_with("OE"))
+                {
+                    func.ref_qual = input.front() == 'R' ? RefQualifier::lvalue : RefQualifier::rvalue;
+                    input.remove_prefix(2);
+                    break;
+                }
+                if (input.empty())
+                    return {.message = "Expected `E` to close the function type."};
+                if (func.c_style_variadic)
+                    return {.message = "A C-style variadic parameter must be the last one."};
+
+                // A lone `void` means no parameters.
+                if (func.params.empty() && input.starts_with('v') && (input.substr(1).starts_with('E') || input.substr(1).starts_with("RE") || input.substr(1).starts_with("OE")))
+                {
+                    input.remove_prefix(1);
+                    continue;
+                }
+
+                if (input.starts_with('z'))
+                {
+                    input.remove_prefix(1);
+                    func.c_style_variadic = true;
+                    continue;
+                }
+
+                MaybeAmbiguousDecl &param = func.params.emplace_back();
+                if (ParseError error = ParseType(input, state, param.type); error.message)
+                    return error;
+            }
+
+            out.modifiers.insert(out.modifiers.begin(), {.var = std::move(func)});
+            return {};
+        }
+
+        // Adds cv-qualifiers to a type. Those go to the outermost modifier that can have them, or to the simple type if there are none.
+        [[nodiscard]] CPPDECL_CONSTEXPR ParseError AddCvQualifiers(Type &type, CvQualifiers quals)
+        {
+            if (quals == CvQualifiers{})
+                return {};
+
+            for (TypeModifier &mod : type.modifiers)
+            {
+                // Cv-qualifying an array cv-qualifies its elements.
+                if (std::holds_alternative<Array>(mod.var))
+                    continue;
+
+                if (auto ptr = std::get_if<Pointer>(&mod.var))
+                    ptr->quals |= quals;
+                else if (auto mem_ptr = std::get_if<MemberPointer>(&mod.var))
+                    mem_ptr->quals |= quals;
+                else if (auto func = std::get_if<Function>(&mod.var))
+                    func->cv_quals |= quals; // This is used in the member function pointers.
+                else
+                    return {.message = "Cv-qualifiers applied to a reference."};
+                return {};
+            }
+
+            type.simple_type.quals |= quals;
+            return {};
+        }
+
+        [[nodiscard]] CPPDECL_CONSTEXPR ParseError ParseType(std::string_view &input, State &state, Type &out)
+        {
+            if (input.empty())
+                return {.message = "Expected a type."};
+
+            const char *begin = input.data();
+
+            // Built-in types. Those are not substitution candidates.
+            SimpleTypeFlags flags{};
+            std::size_t mangled_length = 0;
+            if (std::string_view name = BuiltInTypeName(input, flags, mangled_length); !name.empty())
+            {
+                out = {};
+                out.simple_type.flags = flags;
+                out.simple_type.name.parts.emplace_back().var = std::string(name);
+                input.remove_prefix(mangled_length);
+                return {};
+            }
+
+            switch (input.front())
+            {
+              case 'K':
+              case 'V':
+              case 'r':
+                {
+                    // The order is always `rVK`.
+                    CvQualifiers quals{};
+                    if (input.starts_with('r'))
+                    {
+                        quals |= CvQualifiers::restrict_;
+                        input.remove_prefix(1);
+                    }
+                    if (input.starts_with('V'))
+                    {
+                        quals |= CvQualifiers::volatile_;
+                        input.remove_prefix(1);
+                    }
+                    if (input.starts_with('K'))
+                    {
+                        quals |= CvQualifiers::const_;
+                        input.remove_prefix(1);
+                    }
+
+                    const bool is_function = input.starts_with('F') || input.starts_with("DoF");
+
+                    if (ParseError error = ParseType(input, state, out); error.message)
+                        return error;
+                    if (ParseError error = AddCvQualifiers(out, quals); error.message)
+                        return error;
+
+                    // A cv-qualified function type (in a member function pointer) is a single substitution candidate, the unqualified one isn't a candidate.
+                    // This is what the demangler does.
+                    if (is_function && state.replay_depth == 0)
+                        state.substitutions.pop_back();
+                }
+                break;
+
+              case 'P':
+              case 'R':
+              case 'O':
+                {
+                    const char kind = input.front();
+                    input.remove_prefix(1);
+                    if (ParseError error = ParseType(input, state, out); error.message)
+                        return error;
+
+                    if (kind == 'P')
+                    {
+                        out.modifiers.insert(out.modifiers.begin(), {.var = Pointer{}});
+                    }
+                    else
+                    {
+                        Reference ref;
+                        ref.kind = kind == 'R' ? RefQualifier::lvalue : RefQualifier::rvalue;
+                        out.modifiers.insert(out.modifiers.begin(), {.var = std::move(ref)});
+                    }
+                }
+                break;
+
+              case 'A':
+                {
+                    input.remove_prefix(1);
+
+                    Array array;
+                    if (!input.starts_with('_'))
+                    {
+                        std::size_t num_digits = 0;
+                        while (num_digits < input.size() && IsDigit(input[num_digits]))
+                            num_digits++;
+                        if (num_digits == 0)
+                            return {.message = "Only the numeric array sizes are supported."};
+
+                        std::string_view digits = input.substr(0, num_digits);
+                        auto result = ParsePseudoExpr(digits);
+                        if (!std::holds_alternative<PseudoExpr>(result) || !digits.empty())
+                            return {.message = "Unable to parse the array size."};
+                        array.size = std::move(std::get<PseudoExpr>(result));
+                        input.remove_prefix(num_digits);
+
+                        if (!input.starts_with('_'))
+                            return {.message = "Expected `_` after the array size."};
+                    }
+                    input.remove_prefix(1);
+
+                    if (ParseError error = ParseType(input, state, out); error.message)
+                        return error;
+                    out.modifiers.insert(out.modifiers.begin(), {.var = std::move(array)});
+                }
+                break;
+
+              case 'F':
+                input.remove_prefix(1);
+                if (ParseError error = ParseFunctionType(input, state, out); error.message)
+                    return error;
+                break;
+
+              case 'M':
+                {
+                    input.remove_prefix(1);
+
+                    Type class_type;
+                    if (ParseError error = ParseType(input, state, class_type); error.message)
+                        return error;
+                    if (!class_type.modifiers.empty() || class_type.simple_type.quals != CvQualifiers{})
+                        return {.message = "The class of a member pointer must be a class type."};
+
+                    if (ParseError error = ParseType(input, state, out); error.message)
+                        return error;
+
+                    MemberPointer mem_ptr;
+                    mem_ptr.base = std::move(class_type.simple_type.name);
+                    out.modifiers.insert(out.modifiers.begin(), {.var = std::move(mem_ptr)});
+                }
+                break;
+
+              case 'D':
+                // `noexcept` function types.
+                if (!input.starts_with("DoF"))
+                    return {.message = "Unsupported type."};
+                input.remove_prefix(3);
+                if (ParseError error = ParseFunctionType(input, state, out); error.message)
+                    return error;
+                std::get<Function>(out.modifiers.front().var).noexcept_ = true;
+                break;
+
+              case 'N':
+                // This adds the substitutions by itself.
+                input.remove_prefix(1);
+                return ParseNestedName(input, state, out);
+
+              case 'S':
+                {
+                    if (input.starts_with("St"))
+                    {
+                        // `std::` itself isn't a substitution candidate.
+                        input.remove_prefix(2);
+                        out = {};
+                        out.simple_type.name.parts.emplace_back().var = std::string("std");
+                        if (ParseError error = ParseSourceName(input, out.simple_type.name.parts.emplace_back()); error.message)
+                            return error;
+                        state.AddSubstitution(begin, input, false);
+                        return ParseTemplateArgumentListIfAny(input, state, out, begin, false);
+                    }
+
+                    // The substitutions themselves are not added again.
+                    bool is_complete_type = false;
+                    if (ParseError error = ParseSubstitutionOrAbbreviation(input, state, out, is_complete_type); error.message)
+                        return error;
+                    if (is_complete_type)
+                        return {};
+                    return ParseTemplateArgumentListIfAny(input, state, out, begin, false);
+                }
+
+              default:
+                if (IsDigit(input.front()))
+                {
+                    out = {};
+                    if (ParseError error = ParseSourceName(input, out.simple_type.name.parts.emplace_back()); error.message)
+                        return error;
+                    state.AddSubstitution(begin, input, false);
+                    return ParseTemplateArgumentListIfAny(input, state, out, begin, false);
+                }
+                // Local names (`Z`), template parameters (`T`), vendor extensions (`U`, `u`), and so on.
+                return {.message = "Unsupported type."};
+            }
+
+            // The compound types are substitution candidates.
+            state.AddSubstitution(begin, input, false);
+            return {};
+        }
+    }
+
+    [[nodiscard]] CPPDECL_CONSTEXPR ParseTypeResult ParseItaniumMangledType(std::string_view &input)
+    {
+        ParseTypeResult ret;
+
+        detail::ParseMangled::State state;
+        Type &type = std::get<Type>(ret);
+        if (ParseError error = detail::ParseMangled::ParseType(input, state, type); error.message)
+            return ret = error, ret;
+
+        return ret;
+    }
+
+
+    namespace detail::ParseMsvcMangled
+    {
+        // The names that can be referred to by the digits `0`..`9`.
+        // There's one table for the entire decorated name, and each template argument list has its own table.
+        struct NameBackrefs
+        {
+            // Those are either plain identifiers, or mangled template names starting with `?$`, or anonymous namespaces starting with `?A`.
+            std::array<std::string_view, 10> names{};
+            std::size_t size = 0;
+
+            CPPDECL_CONSTEXPR void Memorize(std::string_view name)
+            {
+                if (size == names.size())
+                    return;
+                for (std::size_t i = 0; i < size; i++)
+                {
+                    if (names[i] == name)
+                        return;
+                }
+                names[size++] = name;
+            }
+        };
+
+        [[nodiscard]] CPPDECL_CONSTEXPR ParseError ParseType(std::string_view &input, NameBackrefs &backrefs, Type &out);
+
+        // Parses a number: `0`..`9` mean 1..10, otherwise it's hex with the digits `A`..`P`, terminated by `@`. `?` in front means negative.
+        [[nodiscard]] CPPDECL_CONSTEXPR ParseError ParseNumber(std::string_view &input, bool allow_negative, bool &negative, std::uint64_t &value)
+        {
+            negative = false;
+            value = 0;
+
+            if (allow_negative && input.starts_with('?'))
+            {
+                negative = true;
+                input.remove_prefix(1);
+            }
+
+            if (!input.empty() && IsDigit(input.front()))
+            {
+                value = std::uint64_t(input.front() - '0') + 1;
+                input.remove_prefix(1);
+                return {};
+            }
+
+            std::size_t num_digits = 0;
+            while (!input.empty() && input.front() >= 'A' && input.front() <= 'P')
+            {
+                if (num_digits++ == 16)
+                    return {.message = "The number is too large."};
+                value = value * 16 + std::uint64_t(input.front() - 'A');
+                input.remove_prefix(1);
+            }
+            if (num_digits == 0 || !input.starts_with('@'))
+                return {.message = "Invalid number."};
+            input.remove_prefix(1);
+            return {};
+        }
+
+        // Converts a number to a `PseudoExpr`. Using the usual parser to make sure we end up with the same tokens as if we parsed the undecorated name.
+        [[nodiscard]] CPPDECL_CONSTEXPR ParseError NumberToPseudoExpr(bool negative, std::uint64_t value, PseudoExpr &out)
+        {
+            std::string text = NumberToString(value);
+            if (negative)
+                text = '-' + text;
+
+            std::string_view text_view = text;
+            auto result = ParsePseudoExpr(text_view);
+            if (!std::holds_alternative<PseudoExpr>(result) || !text_view.empty())
+                return {.message = "Unable to parse the number."};
+            out = std::move(std::get<PseudoExpr>(result));
+            return {};
+        }
+
+        // Parses a cv-qualifier code: `A`..`D`.
+        [[nodiscard]] CPPDECL_CONSTEXPR ParseError ParseCvQualifiers(std::string_view &input, CvQualifiers &out)
+        {
+            switch (input.empty() ? '\0' : input.front())
+            {
+                case 'A': out = {}; break;
+                case 'B': out = CvQualifiers::const_; break;
+                case 'C': out = CvQualifiers::volatile_; break;
+                case 'D': out = CvQualifiers::const_ | CvQualifiers::volatile_; break;
+              default:
+                return {.message = "Unsupported cv-qualifiers."};
+            }
+            input.remove_prefix(1);
+            return {};
+        }
+
+        // Parses the qualifiers of a pointer or reference itself, that go after `P` and such: `__ptr64`, `__restrict`, `__unaligned`.
+        [[nodiscard]] CPPDECL_CONSTEXPR CvQualifiers ParsePointerQualifiers(std::string_view &input)
+        {
+            CvQualifiers ret{};
+            if (input.starts_with('E'))
+            {
+                ret |= CvQualifiers::msvc_ptr64;
+                input.remove_prefix(1);
+            }
+            if (input.starts_with('I'))
+            {
+                ret |= CvQualifiers::restrict_;
+                input.remove_prefix(1);
+            }
+            if (input.starts_with('F'))
+            {
+                ret |= CvQualifiers::msvc_unaligned;
+                input.remove_prefix(1);
+            }
+            return ret;
+        }
+
+        // Parses an identifier terminated by `@`.
+        [[nodiscard]] CPPDECL_CONSTEXPR ParseError ParseSimpleName(std::string_view &input, std::string_view &out)
+        {
+            std::size_t length = IdentifierRunLength(input);
+            if (length == 0 || length >= input.size() || input[length] != '@')
+                return {.message = "Unsupported name."}; // E.g. lambdas, which are `<lambda_...>`.
+            out = input.substr(0, length);
+            input.remove_prefix(length + 1);
+            return {};
+        }
+
+        // Parses `?$name@args...@`, after `?$` was already consumed. This uses a new table of back-references.
+        [[nodiscard]] CPPDECL_CONSTEXPR ParseError ParseTemplateName(std::string_view &input, UnqualifiedName &out)
+        {
+            NameBackrefs backrefs;
+
+            std::string_view name;
+            if (ParseError error = ParseSimpleName(input, name); error.message)
+                return error;
+            backrefs.Memorize(name);
+            out.var = std::string(name);
+
+            TemplateArgumentList &list = out.template_args.emplace();
+
+            while (true)
+            {
+                if (input.empty())
+                    return {.message = "Expected `@` to close the template argument list."};
+                if (input.front() == '@')
+                {
+                    input.remove_prefix(1);
+                    return {};
+                }
+
+                // An empty pack, and a pack separator.
+                if (input.starts_with("$$V") || input.starts_with("$$Z"))
+                {
+                    input.remove_prefix(3);
+                    continue;
+                }
+
+                // An integer.
+                if (input.starts_with("$0"))
+                {
+                    input.remove_prefix(2);
+                    bool negative = false;
+                    std::uint64_t value = 0;
+                    if (ParseError error = ParseNumber(input, true, negative, value); error.message)
+                        return error;
+                    TemplateArgument &arg = list.args.emplace_back();
+                    if (ParseError error = NumberToPseudoExpr(negative, value, arg.var.emplace<PseudoExpr>()); error.message)
+                        return error;
+                    continue;
+                }
+
+                // Other kinds of non-type arguments. Note that `$$B`, `$$C`, and `$$Q` are types.
+                if (input.starts_with('$') && !input.starts_with("$$B") && !input.starts_with("$$C") && !input.starts_with("$$Q"))
+                    return {.message = "Unsupported kind of template argument."};
+
+                Type type;
+                if (ParseError error = ParseType(input, backrefs, type); error.message)
+                    return error;
+                list.args.push_back({.var = std::move(type)});
+            }
+        }
+
+        // Parses one part of a qualified name. Here `is_first` means the rightmost part, since they are stored in the reverse order.
+        [[nodiscard]] CPPDECL_CONSTEXPR ParseError ParseNamePart(std::string_view &input, NameBackrefs &backrefs, bool is_first, UnqualifiedName &out)
+        {
+            if (input.empty())
+                return {.message = "Expected a name."};
+
+            // A back-reference.
+            if (IsDigit(input.front()))
+            {
+                std::size_t index = std::size_t(input.front() - '0');
+                if (index >= backrefs.size)
+                    return {.message = "The back-reference is out of range."};
+                input.remove_prefix(1);
+
+                std::string_view name = backrefs.names[index];
+                if (name.starts_with("?$"))
+                {
+                    name.remove_prefix(2);
+                    return ParseTemplateName(name, out);
+                }
+                if (name.starts_with("?A"))
+                    out.var = UnspellableName{.name = "`anonymous namespace'"};
+                else
+                    out.var = std::string(name);
+                return {};
+            }
+
+            if (input.starts_with("?$"))
+            {
+                const char *begin = input.data();
+                input.remove_prefix(2);
+                if (ParseError error = ParseTemplateName(input, out); error.message)
+                    return error;
+                backrefs.Memorize(std::string_view(begin, std::size_t(input.data() - begin)));
+                return {};
+            }
+
+            // An anonymous namespace, `?A0x12345678@`.
+            if (!is_first && input.starts_with("?A"))
+            {
+                std::size_t end = input.find('@');
+                if (end == std::string_view::npos)
+                    return {.message = "Expected `@` after the anonymous namespace."};
+                backrefs.Memorize(input.substr(0, end));
+                out.var = UnspellableName{.name = "`anonymous namespace'"};
+                input.remove_prefix(end + 1);
+                return {};
+            }
+
+            if (input.starts_with('?'))
+                return {.message = "Unsupported name."}; // E.g. the local names.
+
+            std::string_view name;
+            if (ParseError error = ParseSimpleName(input, name); error.message)
+                return error;
+            backrefs.Memorize(name);
+            out.var = std::string(name);
+            return {};
+        }
+
+        // Parses a qualified name terminated by `@`. The parts are stored in the reverse order.
+        [[nodiscard]] CPPDECL_CONSTEXPR ParseError ParseQualifiedName(std::string_view &input, NameBackrefs &backrefs, QualifiedName &out)
+        {
+            while (!input.starts_with('@'))
+            {
+                if (input.empty())
+                    return {.message = "Expected `@` to close the name."};
+                if (ParseError error = ParseNamePart(input, backrefs, out.parts.empty(), out.parts.emplace_back()); error.message)
+                    return error;
+            }
+            input.remove_prefix(1);
+
+            std::reverse(out.parts.begin(), out.parts.end());
+            return {};
+        }
+
+        [[nodiscard]] CPPDECL_CONSTEXPR ParseError ParseType(std::string_view &input, NameBackrefs &backrefs, Type &out)
+        {
+            out = {};
+
+            if (input.empty())
+                return {.message = "Expected a type."};
+
+            // Built-in types.
+            auto BuiltInType = [&](std::size_t mangled_length, std::string_view name, SimpleTypeFlags flags = {}) -> ParseError
+            {
+                out.simple_type.flags = flags;
+                out.simple_type.name.parts.emplace_back().var = std::string(name);
+                input.remove_prefix(mangled_length);
+                return {};
+            };
+            switch (input.front())
+            {
+                case 'C': return BuiltInType(1, "char", SimpleTypeFlags::explicitly_signed);
+                case 'D': return BuiltInType(1, "char");
+                case 'E': return BuiltInType(1, "char", SimpleTypeFlags::unsigned_);
+                case 'F': return BuiltInType(1, "short");
+                case 'G': return BuiltInType(1, "short", SimpleTypeFlags::unsigned_);
+                case 'H': return BuiltInType(1, "int");
+                case 'I': return BuiltInType(1, "int", SimpleTypeFlags::unsigned_);
+                case 'J': return BuiltInType(1, "long");
+                case 'K': return BuiltInType(1, "long", SimpleTypeFlags::unsigned_);
+                case 'M': return BuiltInType(1, "float");
+                case 'N': return BuiltInType(1, "double");
+                case 'O': return BuiltInType(1, "long double");
+                case 'X': return BuiltInType(1, "void");
+              case '_':
+                switch (input.size() < 2 ? '\0' : input[1])
+                {
+                    case 'N': return BuiltInType(2, "bool");
+                    case 'J': return BuiltInType(2, "long long"); // `__int64`
+                    case 'K': return BuiltInType(2, "long long", SimpleTypeFlags::unsigned_); // `unsigned __int64`
+                    case 'W': return BuiltInType(2, "wchar_t");
+                    case 'S': return BuiltInType(2, "char16_t");
+                    case 'U': return BuiltInType(2, "char32_t");
+                    case 'Q': return BuiltInType(2, "char8_t");
+                }
+                return {.message = "Unsupported type."};
+            }
+
+            // Classes, structs, unions, enums.
+            {
+                SimpleTypePrefix prefix{};
+                std::size_t prefix_length = 1;
+                switch (input.front())
+                {
+                    case 'T': prefix = SimpleTypePrefix::union_; break;
+                    case 'U': prefix = SimpleTypePrefix::struct_; break;
+                    case 'V': prefix = SimpleTypePrefix::class_; break;
+                  case 'W':
+                    // This is followed by a digit that specifies the underlying type, which isn't a part of the undecorated name.
+                    if (input.size() < 2 || !IsDigit(input[1]))
+                        return {.message = "Expected a digit after `W`."};
+                    prefix = SimpleTypePrefix::enum_;
+                    prefix_length = 2;
+                    break;
+                }
+                if (prefix != SimpleTypePrefix{})
+                {
+                    input.remove_prefix(prefix_length);
+                    out.simple_type.prefix = prefix;
+                    return ParseQualifiedName(input, backrefs, out.simple_type.name);
+                }
+            }
+
+            // Pointers.
+            if (input.front() == 'P' || input.front() == 'Q' || input.front() == 'R' || input.front() == 'S')
+            {
+                Pointer ptr;
+                if (input.front() == 'Q' || input.front() == 'S')
+                    ptr.quals |= CvQualifiers::const_;
+                if (input.front() == 'R' || input.front() == 'S')
+                    ptr.quals |= CvQualifiers::volatile_;
+                input.remove_prefix(1);
+
+                if (input.starts_with('6') || input.starts_with('8'))
+                    return {.message = "Function pointers are not supported."};
+
+                ptr.quals |= ParsePointerQualifiers(input);
+
+                CvQualifiers target_quals{};
+                if (ParseError error = ParseCvQualifiers(input, target_quals); error.message)
+                    return error;
+                if (ParseError error = ParseType(input, backrefs, out); error.message)
+                    return error;
+                if (ParseError error = detail::ParseMangled::AddCvQualifiers(out, target_quals); error.message)
+                    return error;
+
+                out.modifiers.insert(out.modifiers.begin(), {.var = std::move(ptr)});
+                return {};
+            }
+
+            // References.
+            if (input.front() == 'A' || input.starts_with("$$Q"))
+            {
+                Reference ref;
+                ref.kind = input.front() == 'A' ? RefQualifier::lvalue : RefQualifier::rvalue;
+                input.remove_prefix(ref.kind == RefQualifier::lvalue ? 1 : 3);
+
+                if (input.starts_with('6'))
+                    return {.message = "Function references are not supported."};
+
+                ref.quals = ParsePointerQualifiers(input);
+
+                CvQualifiers target_quals{};
+                if (ParseError error = ParseCvQualifiers(input, target_quals); error.message)
+                    return error;
+                if (ParseError error = ParseType(input, backrefs, out); error.message)
+                    return error;
+                if (ParseError error = detail::ParseMangled::AddCvQualifiers(out, target_quals); error.message)
+                    return error;
+
+                out.modifiers.insert(out.modifiers.begin(), {.var = std::move(ref)});
+                return {};
+            }
+
+            // Arrays.
+            if (input.front() == 'Y')
+            {
+                input.remove_prefix(1);
+
+                bool negative = false;
+                std::uint64_t num_dims = 0;
+                if (ParseError error = ParseNumber(input, false, negative, num_dims); error.message)
+                    return error;
+                if (num_dims > input.size())
+                    return {.message = "Too many array dimensions."};
+
+                std::vector<TypeModifier> arrays;
+                for (std::uint64_t i = 0; i < num_dims; i++)
+                {
+                    std::uint64_t size = 0;
+                    if (ParseError error = ParseNumber(input, false, negative, size); error.message)
+                        return error;
+                    if (ParseError error = NumberToPseudoExpr(false, size, arrays.emplace_back().var.emplace<Array>().size); error.message)
+                        return error;
+                }
+
+                CvQualifiers elem_quals{};
+                if (input.starts_with("$$C"))
+                {
+                    input.remove_prefix(3);
+                    if (ParseError error = ParseCvQualifiers(input, elem_quals); error.message)
+                        return error;
+                }
+
+                if (ParseError error = ParseType(input, backrefs, out); error.message)
+                    return error;
+                if (ParseError error = detail::ParseMangled::AddCvQualifiers(out, elem_quals); error.message)
+                    return error;
+
+                out.modifiers.insert(out.modifiers.begin(), std::make_move_iterator(arrays.begin()), std::make_move_iterator(arrays.end()));
+                return {};
+            }
+
+            // `$$B` is used before array types in template arguments and at the top level.
+            if (input.starts_with("$$B"))
+            {
+                input.remove_prefix(3);
+                return ParseType(input, backrefs, out);
+            }
+
+            // A cv-qualified type in a template argument.
+            if (input.starts_with("$$C"))
+            {
+                input.remove_prefix(3);
+                CvQualifiers quals{};
+                if (ParseError error = ParseCvQualifiers(input, quals); error.message)
+                    return error;
+                if (ParseError error = ParseType(input, backrefs, out); error.message)
+                    return error;
+                return detail::ParseMangled::AddCvQualifiers(out, quals);
+            }
+
+            // Back-references to types, function types, `nullptr_t`, and so on.
+            return {.message = "Unsupported type."};
+        }
+    }
+
+    [[nodiscard]] CPPDECL_CONSTEXPR ParseTypeResult ParseMsvcDecoratedType(std::string_view &input)
+    {
+        ParseTypeResult ret;
+
+        if (input.starts_with('.'))
+            input.remove_prefix(1);
+
+        // The class types at the top level have `?A` in front of them, where `A` are the cv-qualifiers (always none in practice).
+        CvQualifiers quals{};
+        if (input.starts_with('?'))
+        {
+            input.remove_prefix(1);
+            if (ParseError error = detail::ParseMsvcMangled::ParseCvQualifiers(input, quals); error.message)
+                return ret = error, ret;
+        }
+
+        detail::ParseMsvcMangled::NameBackrefs backrefs;
+        Type &type = std::get<Type>(ret);
+        if (ParseError error = detail::ParseMsvcMangled::ParseType(input, backrefs, type); error.message)
+            return ret = error, ret;
+        if (ParseError error = detail::ParseMangled::AddCvQualifiers(type, quals); error.message)
+            return ret = error, ret;
+
+        return ret;
+    }
+}
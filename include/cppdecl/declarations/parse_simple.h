@@ -8,83 +8,162 @@
 #include <string_view>
 #include <string>
 #include <unordered_map>
+#include <variant>
 
 // Some simple parsing functions that throw on failure, and throw if some part of the string was left unparsed.
 // Those also don't support all of the entities, only the most popular ones.
 //
-// If you need more control than this, use `parse.h` directly. Same if you don't want exceptions.
+// If you don't want exceptions, use the `TryParse..._Simple()` functions, which return `SimpleParseError` instead.
+// If you need more control than this, use `parse.h` directly.
 
 namespace cppdecl
 {
-    [[nodiscard]] CPPDECL_CONSTEXPR Type ParseType_Simple(std::string_view input, ParseTypeFlags flags = {})
+    // Describes why one of the `TryParse..._Simple()` functions failed.
+    // Unlike the exceptions thrown by the `Parse..._Simple()` functions, this doesn't allocate.
+    struct SimpleParseError
     {
-        const std::string_view input_before_parse = input;
-        ParseTypeResult ret = ParseType(input, flags);
+        enum class Kind
+        {
+            parse_error, // The parser itself failed.
+            unparsed_junk, // The parsing succeeded, but some suffix of the input was left unparsed.
+            member_pointer, // `TryParseQualifiedName_Simple()` got a member pointer (`A::*`) instead of a name.
+        };
+        Kind kind{};
+
+        // For `parse_error`, the offset of the error in the input. For `unparsed_junk`, the offset of the unparsed suffix. Otherwise zero.
+        std::size_t position = 0;
 
-        // Handle parse error.
-        if (auto error = std::get_if<ParseError>(&ret))
-            throw std::runtime_error("cppdecl: Parse error in type `" + std::string(input_before_parse) + "` at position " + NumberToString(input.data() - input_before_parse.data()) + ": " + error->message);
+        // For `parse_error`, the message from the parser. Otherwise null.
+        const char *message = nullptr;
+
+        // Makes the same message that the `Parse..._Simple()` functions throw.
+        // `input` must be the same string that was parsed, and `entity` is what we were parsing: "type", "declaration", or "qualified name".
+        [[nodiscard]] CPPDECL_CONSTEXPR std::string ToString(std::string_view input, std::string_view entity) const
+        {
+            switch (kind)
+            {
+              case Kind::parse_error:
+                return "cppdecl: Parse error in " + std::string(entity) + " `" + std::string(input) + "` at position " + NumberToString(position) + ": " + message;
+              case Kind::unparsed_junk:
+                return "cppdecl: Unparsed junk in " + std::string(entity) + " `" + std::string(input) + "` starting from position " + NumberToString(position) + ": `" + std::string(input.substr(position)) + "`.";
+              case Kind::member_pointer:
+                return "cppdecl: Expected `" + std::string(input) + "` to be a " + std::string(entity) + ", but it includes a `::*`, which makes it a member pointer.";
+            }
+            return "cppdecl: Unknown error.";
+        }
+    };
+
+    template <typename T>
+    using SimpleParseResult = std::variant<T, SimpleParseError>;
+
+    namespace detail::ParseSimple
+    {
+        // If `ret` is an error, converts it to `SimpleParseError`. Otherwise checks that `input` was fully consumed.
+        // Returns true on success, then you still need to set the result.
+        template <typename T, typename U>
+        [[nodiscard]] CPPDECL_CONSTEXPR bool CheckResult(SimpleParseResult<T> &out, const U &ret, std::string_view input_before_parse, std::string_view input)
+        {
+            if (auto error = std::get_if<ParseError>(&ret))
+            {
+                out = SimpleParseError{.kind = SimpleParseError::Kind::parse_error, .position = std::size_t(input.data() - input_before_parse.data()), .message = error->message};
+                return false;
+            }
 
-        // Handle unparsed junk at the end.
-        assert(input.empty() || !IsWhitespace(input.back())); // `ParseType()` is expected to leave no whitespace.
-        TrimLeadingWhitespace(input); // But trim it just in case.
-        if (!input.empty())
-            throw std::runtime_error("cppdecl: Unparsed junk in type `" + std::string(input_before_parse) + "` starting from position " + NumberToString(input.data() - input_before_parse.data()) + ": `" + std::string(input) + "`.");
+            if (!input.empty())
+            {
+                out = SimpleParseError{.kind = SimpleParseError::Kind::unparsed_junk, .position = std::size_t(input.data() - input_before_parse.data()), .message = nullptr};
+                return false;
+            }
 
-        return std::get<Type>(ret);
+            return true;
+        }
     }
 
-    // Note that the default value of `flags`, `ParseDeclFlags::accept_everything`, will happily accept unnamed declarations (i.e. just types).
-    // If that's not what's desired, pass either `accept_all_named` or `accept_unqualified_named`.
-    // Note, the default flags must be synced with `DeclParser` below.
-    [[nodiscard]] CPPDECL_CONSTEXPR MaybeAmbiguousDecl ParseDecl_Simple(std::string_view input, ParseDeclFlags flags = ParseDeclFlags::accept_everything)
+    // Those are the non-throwing versions of the functions below. See `SimpleParseError` for the error handling.
+
+    [[nodiscard]] CPPDECL_CONSTEXPR SimpleParseResult<Type> TryParseType_Simple(std::string_view input, ParseTypeFlags flags = {})
     {
+        SimpleParseResult<Type> ret;
+
         const std::string_view input_before_parse = input;
-        ParseDeclResult ret = ParseDecl(input, flags);
+        ParseTypeResult result = ParseType(input, flags);
 
-        // Handle parse error.
-        if (auto error = std::get_if<ParseError>(&ret))
-            throw std::runtime_error("cppdecl: Parse error in declaration `" + std::string(input_before_parse) + "` at position " + NumberToString(input.data() - input_before_parse.data()) + ": " + error->message);
+        if (detail::ParseSimple::CheckResult(ret, result, input_before_parse, input))
+            ret = std::move(std::get<Type>(result));
+        return ret;
+    }
 
-        // Handle unparsed junk at the end.
-        assert(input.empty() || !IsWhitespace(input.back())); // `ParseDecl()` is expected to leave no whitespace.
-        TrimLeadingWhitespace(input); // But trim it just in case.
-        if (!input.empty())
-            throw std::runtime_error("cppdecl: Unparsed junk in declaration `" + std::string(input_before_parse) + "` starting from position " + NumberToString(input.data() - input_before_parse.data()) + ": `" + std::string(input) + "`.");
+    // See `ParseDecl_Simple()` below for the notes about `flags`.
+    [[nodiscard]] CPPDECL_CONSTEXPR SimpleParseResult<MaybeAmbiguousDecl> TryParseDecl_Simple(std::string_view input, ParseDeclFlags flags = ParseDeclFlags::accept_everything)
+    {
+        SimpleParseResult<MaybeAmbiguousDecl> ret;
 
-        return std::get<MaybeAmbiguousDecl>(ret);
+        const std::string_view input_before_parse = input;
+        ParseDeclResult result = ParseDecl(input, flags);
+
+        if (detail::ParseSimple::CheckResult(ret, result, input_before_parse, input))
+            ret = std::move(std::get<MaybeAmbiguousDecl>(result));
+        return ret;
     }
 
-    [[nodiscard]] CPPDECL_CONSTEXPR QualifiedName ParseQualifiedName_Simple(std::string_view input, ParseQualifiedNameFlags flags = {})
+    [[nodiscard]] CPPDECL_CONSTEXPR SimpleParseResult<QualifiedName> TryParseQualifiedName_Simple(std::string_view input, ParseQualifiedNameFlags flags = {})
     {
-        const std::string_view input_before_parse = input;
-        ParseQualifiedNameResult ret = ParseQualifiedName(input, flags);
+        SimpleParseResult<QualifiedName> ret;
 
-        // Handle parse error.
-        if (auto error = std::get_if<ParseError>(&ret))
-            throw std::runtime_error("cppdecl: Parse error in qualified name `" + std::string(input_before_parse) + "` at position " + NumberToString(input.data() - input_before_parse.data()) + ": " + error->message);
+        const std::string_view input_before_parse = input;
+        ParseQualifiedNameResult result = ParseQualifiedName(input, flags);
 
-        // Handle unparsed junk at the end.
-        // `ParseQualifiedName` is not guaranteed to not leave whitespace.
-        if (!input.empty())
-            throw std::runtime_error("cppdecl: Unparsed junk in qualified name `" + std::string(input_before_parse) + "` starting from position " + NumberToString(input.data() - input_before_parse.data()) + ": `" + std::string(input) + "`.");
+        // Note that `ParseQualifiedName` is not guaranteed to not leave whitespace, so it can be reported as unparsed junk.
+        if (!detail::ParseSimple::CheckResult(ret, result, input_before_parse, input))
+            return ret;
 
         // Complain if this is a member pointer. Here we only want qualified names.
-        if (std::holds_alternative<MemberPointer>(ret))
-            throw std::runtime_error("cppdecl: Expected `" + std::string(input_before_parse) + "` to be a qualified name, but it includes a `::*`, which makes it a member pointer.");
+        if (std::holds_alternative<MemberPointer>(result))
+            return ret = SimpleParseError{.kind = SimpleParseError::Kind::member_pointer, .position = 0, .message = nullptr}, ret;
 
-        return std::get<QualifiedName>(ret);
+        ret = std::move(std::get<QualifiedName>(result));
+        return ret;
+    }
+
+
+    [[nodiscard]] CPPDECL_CONSTEXPR Type ParseType_Simple(std::string_view input, ParseTypeFlags flags = {})
+    {
+        auto ret = TryParseType_Simple(input, flags);
+        if (auto error = std::get_if<SimpleParseError>(&ret))
+            throw std::runtime_error(error->ToString(input, "type"));
+        return std::move(std::get<Type>(ret));
+    }
+
+    // Note that the default value of `flags`, `ParseDeclFlags::accept_everything`, will happily accept unnamed declarations (i.e. just types).
+    // If that's not what's desired, pass either `accept_all_named` or `accept_unqualified_named`.
+    // Note, the default flags must be synced with `TryParseDecl_Simple()` above and `DeclParser` below.
+    [[nodiscard]] CPPDECL_CONSTEXPR MaybeAmbiguousDecl ParseDecl_Simple(std::string_view input, ParseDeclFlags flags = ParseDeclFlags::accept_everything)
+    {
+        auto ret = TryParseDecl_Simple(input, flags);
+        if (auto error = std::get_if<SimpleParseError>(&ret))
+            throw std::runtime_error(error->ToString(input, "declaration"));
+        return std::move(std::get<MaybeAmbiguousDecl>(ret));
+    }
+
+    [[nodiscard]] CPPDECL_CONSTEXPR QualifiedName ParseQualifiedName_Simple(std::string_view input, ParseQualifiedNameFlags flags = {})
+    {
+        auto ret = TryParseQualifiedName_Simple(input, flags);
+        if (auto error = std::get_if<SimpleParseError>(&ret))
+            throw std::runtime_error(error->ToString(input, "qualified name"));
+        return std::move(std::get<QualifiedName>(ret));
     }
 
 
     // This is a CRTP base.
+    // Both the successful results and the errors are cached, so parsing the same invalid string again is cheap too.
     template <typename Derived, typename T>
     class BasicParser
     {
-        std::unordered_map<std::string, T> cache;
+        std::unordered_map<std::string, SimpleParseResult<T>> cache;
 
       public:
-        [[nodiscard]] const T &operator()(const std::string &str)
+        // Returns either the result or the error. Doesn't throw on parse errors.
+        [[nodiscard]] const SimpleParseResult<T> &TryParse(const std::string &str)
         {
             auto [iter, is_new] = cache.try_emplace(str); // Sadly this doesn't accept `std::string_view` out of the box.
             if (is_new)
@@ -92,12 +171,12 @@ namespace cppdecl
                 struct Guard
                 {
                     BasicParser *self;
-                    decltype(iter) iter;
+                    decltype(iter) it;
 
                     ~Guard()
                     {
                         if (self)
-                            self->cache.erase(iter);
+                            self->cache.erase(it);
                     }
                 };
 
@@ -110,32 +189,43 @@ namespace cppdecl
 
             return iter->second;
         }
+
+        // Throws on parse errors, with the same messages as the `Parse..._Simple()` functions.
+        [[nodiscard]] const T &operator()(const std::string &str)
+        {
+            const SimpleParseResult<T> &ret = TryParse(str);
+            if (auto error = std::get_if<SimpleParseError>(&ret))
+                throw std::runtime_error(error->ToString(str, Derived::entity_name));
+            return std::get<T>(ret);
+        }
     };
 
-    // This calls `ParseType_Simple()` and memoizes the results.
+    // This calls `TryParseType_Simple()` and memoizes the results.
     class TypeParser : public BasicParser<TypeParser, Type>
     {
         ParseTypeFlags flags;
 
         friend BasicParser<TypeParser, Type>;
-        Type Parse(std::string_view str)
+        static constexpr std::string_view entity_name = "type";
+        SimpleParseResult<Type> Parse(std::string_view str)
         {
-            return ParseType_Simple(str, flags);
+            return TryParseType_Simple(str, flags);
         }
 
       public:
         TypeParser(ParseTypeFlags flags = {}) : flags(flags) {}
     };
 
-    // This calls `ParseDecl_Simple()` and memoizes the results.
+    // This calls `TryParseDecl_Simple()` and memoizes the results.
     class DeclParser : public BasicParser<DeclParser, MaybeAmbiguousDecl>
     {
         ParseDeclFlags flags;
 
         friend BasicParser<DeclParser, MaybeAmbiguousDecl>;
-        MaybeAmbiguousDecl Parse(std::string_view str)
+        static constexpr std::string_view entity_name = "declaration";
+        SimpleParseResult<MaybeAmbiguousDecl> Parse(std::string_view str)
         {
-            return ParseDecl_Simple(str, flags);
+            return TryParseDecl_Simple(str, flags);
         }
 
       public:
@@ -143,15 +233,16 @@ namespace cppdecl
         DeclParser(ParseDeclFlags flags = ParseDeclFlags::accept_everything) : flags(flags) {}
     };
 
-    // This calls `ParseQualifiedName_Simple()` and memoizes the results.
+    // This calls `TryParseQualifiedName_Simple()` and memoizes the results.
     class QualifiedNameParser : public BasicParser<QualifiedNameParser, QualifiedName>
     {
         ParseQualifiedNameFlags flags;
 
         friend BasicParser<QualifiedNameParser, QualifiedName>;
-        QualifiedName Parse(std::string_view str)
+        static constexpr std::string_view entity_name = "qualified name";
+        SimpleParseResult<QualifiedName> Parse(std::string_view str)
         {
-            return ParseQualifiedName_Simple(str, flags);
+            return TryParseQualifiedName_Simple(str, flags);
         }
 
       public:
@@ -0,0 +1,367 @@
+#pragma once
+
+#include "cppdecl/declarations/data.h"
+#include "cppdecl/declarations/parse.h"
+#include "cppdecl/misc/string_helpers.h"
+
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <optional>
+#include <string_view>
+#include <string>
+#include <variant>
+#include <vector>
+
+// Non-owning "views" of qualified names and simple types, for read-only workloads.
+// Instead of copying every identifier into a `std::string`, those refer to the input string, so it must outlive them.
+// Template argument lists aren't parsed at all, only checked for balanced brackets, and stored as raw text.
+// The views can be converted to the normal owning representation on demand, see `ToQualifiedName()` and `ToSimpleType()`.
+//
+// This intentionally only supports the most common subset of the syntax: plain identifiers, `::`, template arguments,
+//   cv-qualifiers, signedness, the built-in type keywords, and the type prefixes (`struct` and such).
+// On anything else (operator names, destructors, unspellable names, attributes, etc) we return `ParseViewUnsupported`,
+//   without consuming any input. Then you should fall back to the normal parser from `parse.h`.
+
+namespace cppdecl
+{
+    // Returned by the view parsers when the input uses syntax that the views don't support.
+    // This isn't necessarily an error, use the normal parser from `parse.h` on the same input.
+    struct ParseViewUnsupported {};
+
+    namespace detail::ParseView
+    {
+        // Should a name consisting of this word be handled by the normal parser instead?
+        [[nodiscard]] constexpr bool IsUnsupportedWord(std::string_view word)
+        {
+            return
+                IsKeywordInCategories(word, KeywordCategories::type_related | KeywordCategories::literal_constant | KeywordCategories::type_prefix | KeywordCategories::cv_qualifier) ||
+                word == "operator" ||
+                word == "template" ||
+                word == "decltype" ||
+                word == "__attribute__" ||
+                word == "__declspec" ||
+                word.starts_with("__ptr");
+        }
+    }
+
+    // An unqualified name, referring to the input string.
+    struct UnqualifiedNameView
+    {
+        // The identifier.
+        std::string_view name;
+
+        // The template argument list including `<` and `>`, or empty if none. It's not parsed, only checked for balanced brackets.
+        std::string_view template_args;
+
+        friend constexpr bool operator==(const UnqualifiedNameView &, const UnqualifiedNameView &) = default;
+
+        [[nodiscard]] constexpr bool HasTemplateArgs() const {return !template_args.empty();}
+
+        // Converts to the owning representation, parsing the template arguments if any.
+        [[nodiscard]] CPPDECL_CONSTEXPR std::variant<UnqualifiedName, ParseError> ToUnqualifiedName() const
+        {
+            std::variant<UnqualifiedName, ParseError> ret;
+            UnqualifiedName &ret_name = std::get<UnqualifiedName>(ret);
+
+            ret_name.var = std::string(name);
+
+            if (HasTemplateArgs())
+            {
+                std::string_view input = template_args;
+                auto result = ParseTemplateArgumentList(input);
+                if (auto error = std::get_if<ParseError>(&result))
+                    return ret = *error, ret;
+
+                TrimLeadingWhitespace(input);
+                if (!input.empty())
+                    return ret = ParseError{.message = "Unparsed junk after the template argument list."}, ret;
+
+                ret_name.template_args = std::move(*std::get<std::optional<TemplateArgumentList>>(result));
+            }
+
+            return ret;
+        }
+    };
+
+    // A qualified name, referring to the input string.
+    struct QualifiedNameView
+    {
+        std::vector<UnqualifiedNameView> parts;
+        bool force_global_scope = false; // True if this has a leading `::`.
+
+        // The entire name as spelled in the input.
+        std::string_view text;
+
+        [[nodiscard]] constexpr bool IsEmpty() const
+        {
+            return parts.empty();
+        }
+
+        // Returns true if the words of `parts` are exactly `words`, ignoring the template arguments and `force_global_scope`.
+        // E.g. `name.WordsAre({"std", "vector"})`.
+        [[nodiscard]] constexpr bool WordsAre(std::initializer_list<std::string_view> words) const
+        {
+            if (parts.size() != words.size())
+                return false;
+            std::size_t i = 0;
+            for (std::string_view word : words)
+            {
+                if (parts[i++].name != word)
+                    return false;
+            }
+            return true;
+        }
+
+        // Converts to the owning representation, parsing the template arguments if any.
+        [[nodiscard]] CPPDECL_CONSTEXPR std::variant<QualifiedName, ParseError> ToQualifiedName() const
+        {
+            std::variant<QualifiedName, ParseError> ret;
+            QualifiedName &ret_name = std::get<QualifiedName>(ret);
+
+            ret_name.force_global_scope = force_global_scope;
+            ret_name.parts.reserve(parts.size());
+
+            for (const UnqualifiedNameView &part : parts)
+            {
+                auto result = part.ToUnqualifiedName();
+                if (auto error = std::get_if<ParseError>(&result))
+                    return ret = *error, ret;
+                ret_name.parts.push_back(std::move(std::get<UnqualifiedName>(result)));
+            }
+
+            return ret;
+        }
+    };
+
+    // A simple type (a decl-specifier-seq), referring to the input string.
+    struct SimpleTypeView
+    {
+        CvQualifiers quals{};
+        // Only `unsigned_` and `explicitly_signed` are set here. The remaining flags need the normal parser.
+        SimpleTypeFlags flags{};
+        SimpleTypePrefix prefix{};
+
+        // If this is a built-in type, the keywords (other than `signed`/`unsigned`) in their original order, e.g. `long` `long` or `double`.
+        // Those aren't normalized, `long int` is stored as is. Use `ToSimpleType()` to normalize them.
+        std::array<std::string_view, 3> builtin_words{};
+        std::size_t num_builtin_words = 0;
+
+        // If this is not a built-in type, the type name.
+        QualifiedNameView name;
+
+        // The entire type as spelled in the input.
+        std::string_view text;
+
+        [[nodiscard]] constexpr bool IsEmpty() const
+        {
+            return name.IsEmpty() && num_builtin_words == 0 && !bool(flags & (SimpleTypeFlags::unsigned_ | SimpleTypeFlags::explicitly_signed));
+        }
+
+        [[nodiscard]] constexpr bool IsBuiltIn() const
+        {
+            return !IsEmpty() && name.IsEmpty();
+        }
+
+        // Converts to the owning representation. This re-parses `text` with `ParseSimpleType()`, since combining the built-in words isn't trivial.
+        [[nodiscard]] CPPDECL_CONSTEXPR ParseSimpleTypeResult ToSimpleType() const
+        {
+            std::string_view input = text;
+            ParseSimpleTypeResult ret = ParseSimpleType(input);
+            if (std::holds_alternative<ParseError>(ret))
+                return ret;
+
+            TrimLeadingWhitespace(input);
+            if (!input.empty())
+                return ret = ParseError{.message = "Unparsed junk after the type."}, ret;
+
+            return ret;
+        }
+    };
+
+    using ParseQualifiedNameViewResult = std::variant<QualifiedNameView, ParseViewUnsupported, ParseError>;
+
+    // Like `ParseQualifiedName()`, but returns a view into `input`.
+    // Returns an empty name if there's nothing to parse. Returns `ParseViewUnsupported` (and leaves `input` unchanged) on any syntax the views don't support.
+    // Ignores leading whitespace. Trailing whitespace is removed only if something was parsed.
+    // Stops before `::*`, since that's a member pointer and not a part of the name.
+    [[nodiscard]] CPPDECL_CONSTEXPR ParseQualifiedNameViewResult ParseQualifiedNameView(std::string_view &input)
+    {
+        ParseQualifiedNameViewResult ret;
+        QualifiedNameView &ret_name = std::get<QualifiedNameView>(ret);
+
+        TrimLeadingWhitespace(input);
+
+        std::string_view s = input;
+
+        if (ConsumePunctuation(s, "::"))
+        {
+            ret_name.force_global_scope = true;
+            TrimLeadingWhitespace(s);
+        }
+
+        while (true)
+        {
+            if (s.empty() || !IsNonDigitIdentifierChar(s.front()))
+            {
+                // Nothing to parse?
+                // Reject the punctuation that can begin an unspellable name or a destructor name.
+                if (!ret_name.parts.empty() || ret_name.force_global_scope || (!s.empty() && std::string_view("(<{'`$~").find(s.front()) != std::string_view::npos))
+                    return ret = ParseViewUnsupported{}, ret;
+
+                return ret;
+            }
+
+            UnqualifiedNameView &part = ret_name.parts.emplace_back();
+            part.name = ConsumeIdentifierChars(s);
+
+            if (detail::ParseView::IsUnsupportedWord(part.name))
+                return ret = ParseViewUnsupported{}, ret;
+
+            TrimLeadingWhitespace(s);
+
+            // The template arguments.
+            // Note that `<<` can't begin a template argument list.
+            if (s.starts_with('<') && !s.starts_with("<<"))
+            {
+                const std::string_view s_before_args = s;
+                if (!detail::Parse::ConsumeBalancedBrackets(s))
+                    return ret = ParseViewUnsupported{}, ret;
+                part.template_args = s_before_args.substr(0, std::size_t(s.data() - s_before_args.data()));
+            }
+
+            ret_name.text = std::string_view(input.data(), std::size_t(s.data() - input.data()));
+            TrimTrailingWhitespace(ret_name.text);
+
+            TrimLeadingWhitespace(s);
+
+            // Continue to the next part?
+            std::string_view s_copy = s;
+            if (!ConsumePunctuation(s_copy, "::"))
+                break;
+            TrimLeadingWhitespace(s_copy);
+
+            // A member pointer. Stop before `::`.
+            if (s_copy.starts_with('*'))
+                break;
+
+            s = s_copy;
+        }
+
+        input = s;
+        return ret;
+    }
+
+    using ParseSimpleTypeViewResult = std::variant<SimpleTypeView, ParseViewUnsupported, ParseError>;
+
+    // Like `ParseSimpleType()`, but returns a view into `input`.
+    // Returns an empty type if there's nothing to parse. Returns `ParseViewUnsupported` (and leaves `input` unchanged) on any syntax the views don't support.
+    // Ignores leading whitespace. Trailing whitespace is removed only if something was parsed.
+    [[nodiscard]] CPPDECL_CONSTEXPR ParseSimpleTypeViewResult ParseSimpleTypeView(std::string_view &input)
+    {
+        ParseSimpleTypeViewResult ret;
+        SimpleTypeView &ret_type = std::get<SimpleTypeView>(ret);
+
+        TrimLeadingWhitespace(input);
+
+        std::string_view s = input;
+        const char *end = input.data();
+
+        while (true)
+        {
+            TrimLeadingWhitespace(s);
+
+            if (s.starts_with("[["))
+                return ret = ParseViewUnsupported{}, ret;
+
+            // A non-word. Either a name starting with `::`, or the end of the type.
+            if (s.empty() || !IsNonDigitIdentifierChar(s.front()))
+            {
+                if (!s.starts_with("::") || !ret_type.IsEmpty())
+                    break;
+            }
+
+            std::string_view s_copy = s;
+            std::string_view word = ConsumeIdentifierChars(s_copy);
+
+            auto AddCvQualifier = [&](CvQualifiers qual) -> bool
+            {
+                if (bool(ret_type.quals & qual))
+                    return false;
+                ret_type.quals |= qual;
+                return true;
+            };
+
+            auto AddSignedness = [&](SimpleTypeFlags flag) -> bool
+            {
+                if (bool(ret_type.flags & (SimpleTypeFlags::unsigned_ | SimpleTypeFlags::explicitly_signed)) || !ret_type.name.IsEmpty())
+                    return false;
+                ret_type.flags |= flag;
+                return true;
+            };
+
+            const KeywordInfo keyword = ClassifyKeyword(word);
+
+            if (keyword.id == Keyword::const_ || keyword.id == Keyword::volatile_)
+            {
+                if (!AddCvQualifier(keyword.id == Keyword::const_ ? CvQualifiers::const_ : CvQualifiers::volatile_))
+                    return ret = ParseViewUnsupported{}, ret;
+            }
+            else if (keyword.id == Keyword::unsigned_ || keyword.id == Keyword::signed_)
+            {
+                if (!AddSignedness(keyword.id == Keyword::unsigned_ ? SimpleTypeFlags::unsigned_ : SimpleTypeFlags::explicitly_signed))
+                    return ret = ParseViewUnsupported{}, ret;
+            }
+            else if (SimpleTypePrefix prefix = StringToSimpleTypePrefix(word); prefix != SimpleTypePrefix::none)
+            {
+                if (ret_type.prefix != SimpleTypePrefix::none || !ret_type.IsEmpty())
+                    return ret = ParseViewUnsupported{}, ret;
+                ret_type.prefix = prefix;
+            }
+            else if (bool(keyword.categories & (KeywordCategories::type_integral | KeywordCategories::type_bool | KeywordCategories::type_floating_point | KeywordCategories::type_void)))
+            {
+                if (!ret_type.name.IsEmpty() || ret_type.num_builtin_words == ret_type.builtin_words.size())
+                    return ret = ParseViewUnsupported{}, ret;
+                ret_type.builtin_words[ret_type.num_builtin_words++] = word;
+            }
+            else if (detail::ParseView::IsUnsupportedWord(word))
+            {
+                return ret = ParseViewUnsupported{}, ret;
+            }
+            else
+            {
+                // Some other name. If we already have a type, this must be the variable name (or something else that we don't care about).
+                if (ret_type.num_builtin_words > 0 || !ret_type.name.IsEmpty())
+                    break;
+
+                // `unsigned A` is wrong. Let the normal parser complain about it.
+                if (bool(ret_type.flags & (SimpleTypeFlags::unsigned_ | SimpleTypeFlags::explicitly_signed)))
+                    return ret = ParseViewUnsupported{}, ret;
+
+                auto name_result = ParseQualifiedNameView(s);
+                if (!std::holds_alternative<QualifiedNameView>(name_result))
+                    return ret = ParseViewUnsupported{}, ret;
+
+                // If the name stopped before `::*`, it's the class of a member pointer rather than the type, like in `ParseSimpleType()`.
+                TrimLeadingWhitespace(s);
+                if (s.starts_with("::"))
+                    break;
+
+                ret_type.name = std::move(std::get<QualifiedNameView>(name_result));
+                end = ret_type.name.text.data() + ret_type.name.text.size();
+                continue;
+            }
+
+            s = s_copy;
+            end = s.data();
+        }
+
+        if (ret_type.IsEmpty() && (ret_type.quals != CvQualifiers{} || ret_type.prefix != SimpleTypePrefix::none))
+            return ret = ParseViewUnsupported{}, ret; // Let the normal parser deal with this.
+
+        ret_type.text = std::string_view(input.data(), std::size_t(end - input.data()));
+        input.remove_prefix(ret_type.text.size());
+        TrimLeadingWhitespace(input);
+        return ret;
+    }
+}
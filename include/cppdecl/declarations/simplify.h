@@ -1886,17 +1886,73 @@ namespace cppdecl
         {
             if (bool(flags & SimplifyFlags::bit_common_normalize_numbers))
             {
-                std::string str = ToCode(lit, ToCodeFlags::weakly_canonical_language_agnostic); // Eh.
-                std::string_view view = str;
-                auto ret = ParseNumericLiteral(view);
-                auto new_lit = std::get_if<std::optional<NumericLiteral>>(&ret);
-                assert(new_lit && *new_lit && view.empty() && "Numeric literal simplification via roundtrip failed, unable to parse the resulting string.");
-                if (new_lit && *new_lit && view.empty())
+                // This produces the same result as printing with `ToCode(..., ToCodeFlags::weakly_canonical_language_agnostic)` and parsing the result again,
+                //   but without the roundtrip through a string. The tests check that those match.
+
+                auto EmptyOrAllZeroes = [](std::string_view input) -> bool
                 {
-                    assert((*new_lit)->IsFloatingPoint() == lit.IsFloatingPoint() && "Numeric literal simplification via roundtrip produced a different kind of literal (integral from floating-point, or vice versa).");
-                    lit = std::move(**new_lit);
-                    assert(ToCode(lit, {}) == str && ToCode(lit, ToCodeFlags::weakly_canonical_language_agnostic) == str && "Numeric literal simplification isn't stable on a roundtrip.");
-                }
+                    for (char ch : input)
+                    {
+                        if (ch != '0' && ch != '\'')
+                            return false;
+                    }
+                    return true;
+                };
+
+                // Removes the `'`s and uppercases the digits.
+                auto NormalizeDigits = [](std::string &str)
+                {
+                    std::erase(str, '\'');
+                    for (char &ch : str)
+                        ch = ToUpper(ch);
+                };
+
+                std::visit(Overload{
+                    [&](NumericLiteral::Integer &i)
+                    {
+                        NormalizeDigits(i.value);
+                        // `cached_value` stays valid.
+                    },
+                    [&](NumericLiteral::FloatingPoint &f)
+                    {
+                        std::string_view exp = f.value_exp;
+                        (void)(ConsumePunctuation(exp, "+") || ConsumePunctuation(exp, "-"));
+                        const bool exp_is_zero = EmptyOrAllZeroes(exp);
+
+                        // Same logic as in `ToCode()`. With those flags, we only drop the zero fractional part before a non-zero exponent,
+                        //   and drop the zero exponent after a fractional part.
+                        const bool have_exp_tentative = f.base == NumericLiteral::FloatingPoint::Base::hex || (f.value_frac ? !exp_is_zero : !f.value_exp.empty());
+                        const bool have_frac = f.value_frac && !(have_exp_tentative && EmptyOrAllZeroes(*f.value_frac));
+                        const bool have_exp = have_exp_tentative || (!have_frac && !f.value_exp.empty() && exp_is_zero);
+
+                        NormalizeDigits(f.value_int);
+                        if (f.value_int.empty())
+                            f.value_int = "0";
+
+                        if (!have_frac)
+                        {
+                            f.value_frac.reset();
+                        }
+                        else
+                        {
+                            NormalizeDigits(*f.value_frac);
+                            if (f.value_frac->empty())
+                                *f.value_frac = "0";
+                        }
+
+                        if (!have_exp)
+                        {
+                            f.value_exp.clear();
+                        }
+                        else
+                        {
+                            // Remove the useless signs: `+`, and `-` before zero.
+                            if (f.value_exp.starts_with('+') || (f.value_exp.starts_with('-') && exp_is_zero))
+                                f.value_exp.erase(0, 1);
+                            std::erase(f.value_exp, '\'');
+                        }
+                    },
+                }, lit.var);
             }
         }
     };
@@ -1914,6 +1970,14 @@ namespace cppdecl
     {
         if (traits.ShouldAct(flags))
         {
+            // Parse the lazy template arguments, if any, to be able to simplify them.
+            // If this fails, the offending lists are left as is.
+            (void)target.template VisitEachComponent<TemplateArgumentList>({}, [](TemplateArgumentList &list)
+            {
+                (void)MaterializeTemplateArgs(list);
+                return VisitResult::recurse;
+            });
+
             (void)target.template VisitEachComponent<QualifiedName, CvQualifiers, SimpleType, NumericLiteral>(
                 // Should this use pre-order or post-order?
                 // With pre-order, we need to compare longer names,
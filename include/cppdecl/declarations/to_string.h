@@ -299,6 +299,10 @@ namespace cppdecl
         assert(!bool(flags & ToCodeFlags::mask_any_half_type));
         assert(!bool(flags & ToCodeFlags::lambda));
 
+        // Not parsed yet, print as is.
+        if (target.IsLazy())
+            return target.unparsed;
+
         std::string ret = "<";
 
         bool first = true;
@@ -326,6 +330,17 @@ namespace cppdecl
 
     [[nodiscard]] CPPDECL_CONSTEXPR std::string ToString(const TemplateArgumentList &target, ToStringFlags flags)
     {
+        // Not parsed yet. We can't do much with the raw spelling.
+        if (target.IsLazy())
+        {
+            if (bool(flags & ToStringFlags::identifier))
+                return KeepOnlyIdentifierChars(target.unparsed);
+            else if (bool(flags & ToStringFlags::debug))
+                return "unparsed`" + target.unparsed + "`";
+            else
+                return "unparsed template arguments `" + target.unparsed + "`";
+        }
+
         if (bool(flags & ToStringFlags::identifier))
         {
             std::string ret;
@@ -2970,6 +2985,10 @@ namespace cppdecl
 
     [[nodiscard]] CPPDECL_CONSTEXPR std::string ToCode(const Attribute &target, ToCodeFlags flags)
     {
+        // See `ParseAttributeListFlags::keep_raw_text`.
+        if (!target.raw_text.empty())
+            return target.raw_text;
+
         std::string ret;
 
         switch (target.style)
@@ -2997,6 +3016,8 @@ namespace cppdecl
         if (bool(flags & ToStringFlags::identifier))
         {
             // This does something, for completeness. But calling `ToString(..., identifier)` on a `SimpleType` will just ignore attirbutes.
+            if (!target.raw_text.empty())
+                return KeepOnlyIdentifierChars(target.raw_text);
             return ToString(target.expr, flags);
         }
         else if (bool(flags & ToStringFlags::debug))
@@ -3017,8 +3038,17 @@ namespace cppdecl
             }
             assert(style_known && "Invalid attribute style enum.");
 
-            ret += ",attr=";
-            ret += ToString(target.expr, flags);
+            if (!target.raw_text.empty())
+            {
+                ret += ",raw=`";
+                ret += target.raw_text;
+                ret += '`';
+            }
+            else
+            {
+                ret += ",attr=";
+                ret += ToString(target.expr, flags);
+            }
             ret += "}";
             return ret;
         }
@@ -3040,8 +3070,17 @@ namespace cppdecl
             }
             assert(style_known && "Invalid attribute style enum.");
 
-            ret += "attribute ";
-            ret += ToString(target.expr, flags);
+            if (!target.raw_text.empty())
+            {
+                ret += "unparsed attribute list `";
+                ret += target.raw_text;
+                ret += '`';
+            }
+            else
+            {
+                ret += "attribute ";
+                ret += ToString(target.expr, flags);
+            }
 
             return ret;
         }
@@ -0,0 +1,204 @@
+#pragma once
+
+#include "cppdecl/declarations/data.h"
+#include "cppdecl/declarations/hash.h"
+#include "cppdecl/misc/identifier_table.h"
+
+#include <cassert>
+#include <cstddef>
+#include <deque>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// A hash-consed representation of types, see `TypeTable`.
+// This is a standalone building block for the code that compares many types over and over (e.g. to deduplicate them).
+// `Simplify()` doesn't use it: the simplifier is `constexpr` and its customization points take `Type`s, so it keeps comparing them structurally.
+
+namespace cppdecl
+{
+    class TypeTable;
+
+    namespace detail::TypeTable
+    {
+        struct Node;
+    }
+
+    // An immutable type stored in a `TypeTable`.
+    // Within one table, equal types are always the same object, so comparing two `InternedType`s is a pointer comparison.
+    // This is a cheap non-owning handle, it remains valid as long as the table is alive.
+    class InternedType
+    {
+        friend cppdecl::TypeTable;
+
+        const detail::TypeTable::Node *node = nullptr;
+
+      public:
+        constexpr InternedType() {}
+
+        [[nodiscard]] constexpr bool IsNull() const {return !node;}
+        [[nodiscard]] constexpr explicit operator bool() const {return bool(node);}
+
+        // This compares the identity. Only makes sense for types from the same table.
+        friend constexpr bool operator==(const InternedType &, const InternedType &) = default;
+
+        // The type itself, but with the type template arguments of `.simple_type.name` replaced with empty types.
+        // Those arguments are available from `TypeArgs()`, in the same order.
+        // We only split off the template arguments of the simple type name, not the ones nested in function parameters and such,
+        //   because those are what the simplification logic compares over and over.
+        [[nodiscard]] const Type &Shell() const;
+
+        // The type template arguments of all parts of `Shell().simple_type.name`, in order. Non-type arguments aren't included.
+        [[nodiscard]] std::span<const InternedType> TypeArgs() const;
+
+        // The interned words of `Shell().simple_type.name.parts`, ignoring their template arguments.
+        // A handle is null if the part isn't a plain word (e.g. if it's an operator name).
+        // Use `TypeTable::Identifiers().Find(...)` to obtain the handles to compare those with.
+        [[nodiscard]] std::span<const Identifier> NameWords() const;
+
+        // The precomputed hash, can be used as a cheap key in hash tables.
+        [[nodiscard]] std::size_t Hash() const;
+
+        // Reconstructs the original `Type`.
+        [[nodiscard]] Type ToType() const;
+    };
+
+    namespace detail::TypeTable
+    {
+        struct Node
+        {
+            Type shell;
+            std::vector<InternedType> type_args;
+            std::vector<Identifier> name_words;
+            std::size_t hash = 0;
+        };
+    }
+
+    inline const Type &InternedType::Shell() const
+    {
+        assert(node);
+        return node->shell;
+    }
+
+    inline std::span<const InternedType> InternedType::TypeArgs() const
+    {
+        assert(node);
+        return node->type_args;
+    }
+
+    inline std::span<const Identifier> InternedType::NameWords() const
+    {
+        assert(node);
+        return node->name_words;
+    }
+
+    inline std::size_t InternedType::Hash() const
+    {
+        assert(node);
+        return node->hash;
+    }
+
+    inline Type InternedType::ToType() const
+    {
+        assert(node);
+
+        Type ret = node->shell;
+        std::size_t i = 0;
+        for (UnqualifiedName &part : ret.simple_type.name.parts)
+        {
+            if (!part.template_args)
+                continue;
+
+            for (TemplateArgument &arg : part.template_args->args)
+            {
+                if (auto type = std::get_if<Type>(&arg.var))
+                    *type = node->type_args.at(i++).ToType();
+            }
+        }
+        assert(i == node->type_args.size());
+        return ret;
+    }
+
+    // Stores each distinct type once, and hands out `InternedType` handles for them.
+    // Identical subtrees (currently, the type template arguments of the simple type names) are shared between the types.
+    // This isn't thread-safe. Use one table per thread (or per some other context), or guard it with a mutex.
+    class TypeTable
+    {
+        // A `std::deque` never moves its elements when appending, so the handles stay valid.
+        std::deque<detail::TypeTable::Node> nodes;
+        std::unordered_multimap<std::size_t, const detail::TypeTable::Node *> nodes_by_hash;
+
+        IdentifierTable identifiers;
+
+      public:
+        TypeTable() {}
+        // The handles point into this object, so copying it makes no sense.
+        TypeTable(const TypeTable &) = delete;
+        TypeTable &operator=(const TypeTable &) = delete;
+
+        // Returns the handle for `type`, adding it to the table if it's not there yet.
+        [[nodiscard]] InternedType Intern(Type type)
+        {
+            detail::TypeTable::Node new_node;
+
+            // Intern the type template arguments first, and replace them with empty types.
+            for (UnqualifiedName &part : type.simple_type.name.parts)
+            {
+                if (!part.template_args)
+                    continue;
+
+                for (TemplateArgument &arg : part.template_args->args)
+                {
+                    if (auto arg_type = std::get_if<Type>(&arg.var))
+                    {
+                        new_node.type_args.push_back(Intern(std::move(*arg_type)));
+                        *arg_type = {};
+                    }
+                }
+            }
+
+            new_node.shell = std::move(type);
+
+            // Since the arguments are replaced with empty types, this is cheap even for deeply nested types.
+            std::size_t hash = cppdecl::Hash(new_node.shell);
+            for (InternedType arg : new_node.type_args)
+                hash ^= arg.Hash() + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+            new_node.hash = hash;
+
+            auto [begin, end] = nodes_by_hash.equal_range(hash);
+            for (auto it = begin; it != end; ++it)
+            {
+                if (it->second->type_args == new_node.type_args && it->second->shell == new_node.shell)
+                {
+                    InternedType ret;
+                    ret.node = it->second;
+                    return ret;
+                }
+            }
+
+            new_node.name_words.reserve(new_node.shell.simple_type.name.parts.size());
+            for (const UnqualifiedName &part : new_node.shell.simple_type.name.parts)
+            {
+                std::string_view word = part.AsSingleWord(SingleWordFlags::ignore_template_args);
+                new_node.name_words.push_back(word.empty() ? Identifier{} : identifiers.Intern(word));
+            }
+
+            InternedType ret;
+            ret.node = &nodes.emplace_back(std::move(new_node));
+            nodes_by_hash.emplace(hash, ret.node);
+            return ret;
+        }
+
+        // The identifiers used in `InternedType::NameWords()`.
+        [[nodiscard]]       IdentifierTable &Identifiers()       {return identifiers;}
+        [[nodiscard]] const IdentifierTable &Identifiers() const {return identifiers;}
+
+        // How many distinct types are stored, including the nested ones.
+        [[nodiscard]] std::size_t size() const
+        {
+            return nodes.size();
+        }
+    };
+}
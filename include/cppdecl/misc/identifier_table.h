@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string_view>
+#include <string>
+#include <unordered_map>
+
+namespace cppdecl
+{
+    // A handle to a string stored in an `IdentifierTable`.
+    // Two handles from the same table are equal if and only if their strings are equal, so comparing them is an integer comparison.
+    struct Identifier
+    {
+        static constexpr std::uint32_t null_index = std::uint32_t(-1);
+
+        std::uint32_t index = null_index;
+
+        [[nodiscard]] constexpr bool IsNull() const {return index == null_index;}
+        [[nodiscard]] constexpr explicit operator bool() const {return !IsNull();}
+
+        friend constexpr bool operator==(const Identifier &, const Identifier &) = default;
+    };
+
+    // An intern table for identifiers (or any other strings).
+    // Each distinct string is stored once, and is referred to by a small `Identifier` handle.
+    // The stored strings never move, so the views returned by `operator[]` remain valid for the lifetime of the table.
+    // This isn't thread-safe. Use one table per thread (or per some other context), or guard it with a mutex.
+    class IdentifierTable
+    {
+        // A `std::deque` never moves its elements when appending, so views into those strings stay valid.
+        std::deque<std::string> strings;
+        std::unordered_map<std::string_view, std::uint32_t> indices;
+
+      public:
+        IdentifierTable() {}
+        // The map holds views into `strings`, so copying would need to rebuild it. We don't need that for now.
+        IdentifierTable(const IdentifierTable &) = delete;
+        IdentifierTable &operator=(const IdentifierTable &) = delete;
+
+        // Returns the handle for `str`, adding it to the table if it's not there yet.
+        [[nodiscard]] Identifier Intern(std::string_view str)
+        {
+            if (auto it = indices.find(str); it != indices.end())
+                return {it->second};
+
+            assert(strings.size() < Identifier::null_index && "Too many identifiers.");
+            std::uint32_t index = std::uint32_t(strings.size());
+            indices.try_emplace(strings.emplace_back(str), index);
+            return {index};
+        }
+
+        // Returns the handle for `str` if it's in the table, or a null handle otherwise.
+        // This is useful to prepare handles for comparisons without growing the table: if the word isn't there, then nothing can be equal to it.
+        [[nodiscard]] Identifier Find(std::string_view str) const
+        {
+            if (auto it = indices.find(str); it != indices.end())
+                return {it->second};
+            return {};
+        }
+
+        // Returns the string for a handle. The handle must be non-null and must come from this table.
+        [[nodiscard]] std::string_view operator[](Identifier id) const
+        {
+            assert(id.index < strings.size());
+            return strings[id.index];
+        }
+
+        // How many distinct strings are stored.
+        [[nodiscard]] std::size_t size() const
+        {
+            return strings.size();
+        }
+    };
+}
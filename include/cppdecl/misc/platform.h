@@ -47,3 +47,21 @@
 #    define CPPDECL_NEED_DEMANGLER 1
 #  endif
 #endif
+
+
+// Whether `string_helpers.h` should use SSE2 intrinsics to scan strings. Define this to 0 to use only the scalar code.
+#ifndef CPPDECL_SSE2
+#  if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define CPPDECL_SSE2 1
+#  else
+#    define CPPDECL_SSE2 0
+#  endif
+#endif
+
+
+// Whether the parser should collect the `ParseStats` (see `parse.h`). Disabled by default, then the counting compiles to nothing.
+// All translation units of a program should agree on this, because it changes the bodies of the inline parsing functions.
+// The layout of `ParseContext` doesn't depend on this.
+#ifndef CPPDECL_PARSE_STATS
+#  define CPPDECL_PARSE_STATS 0
+#endif
@@ -4,12 +4,21 @@
 #include "cppdecl/misc/platform.h"
 
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <cassert>
 #include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
 #include <string_view>
 #include <string>
 #include <type_traits>
 
+#if CPPDECL_SSE2
+#include <emmintrin.h>
+#endif
+
 namespace cppdecl
 {
     // --- Character classification:
@@ -19,28 +28,6 @@ namespace cppdecl
         // Intentionally not adding `\v` here. Who uses that?
         return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n';
     }
-    // Remove any prefix whitespace from `str`.
-    // Returns true if at least one removed.
-    constexpr bool TrimLeadingWhitespace(std::string_view &str)
-    {
-        bool ret = false;
-        while (!str.empty() && IsWhitespace(str.front()))
-        {
-            str.remove_prefix(1);
-            ret = true;
-        }
-        return ret;
-    }
-    constexpr bool TrimTrailingWhitespace(std::string_view &str)
-    {
-        bool ret = false;
-        while (!str.empty() && IsWhitespace(str.back()))
-        {
-            str.remove_suffix(1);
-            ret = true;
-        }
-        return ret;
-    }
 
     // A constexpr replacement for `std::to_string()`.
     [[nodiscard]] CPPDECL_CONSTEXPR std::string NumberToString(std::integral auto n)
@@ -136,6 +123,360 @@ namespace cppdecl
             ch = ToUpper(ch);
     }
 
+
+    // --- Scanning:
+    // Those have SSE2 paths (unless disabled with `CPPDECL_SSE2`, see `platform.h`), and scalar fallbacks for other platforms and for constexpr evaluation.
+
+    namespace detail::StringHelpers
+    {
+        enum class CharClass
+        {
+            whitespace, // `IsWhitespace()`
+            identifier, // `IsIdentifierChar()`
+        };
+
+        [[nodiscard]] constexpr bool CharMatches(CharClass c, char ch)
+        {
+            switch (c)
+            {
+                case CharClass::whitespace: return IsWhitespace(ch);
+                case CharClass::identifier: return IsIdentifierChar(ch);
+            }
+            return false;
+        }
+
+        #if CPPDECL_SSE2
+        // Returns a mask with the bits set for the characters matching `c`, among the 16 characters starting at `ptr`.
+        // The pointer doesn't need to be aligned.
+        [[nodiscard]] inline unsigned CharClassMask16(CharClass c, const char *ptr)
+        {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr));
+            __m128i m{};
+            switch (c)
+            {
+              case CharClass::whitespace:
+                m = _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))),
+                    _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\r')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\n')))
+                );
+                break;
+              case CharClass::identifier:
+                {
+                    // The comparisons are signed, so the non-ASCII bytes are negative and never match the ranges.
+                    // `| 0x20` maps the uppercase letters to lowercase, and doesn't map any non-letters into the letter range.
+                    const __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+                    const __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lower, _mm_set1_epi8('z' + 1)));
+                    const __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+                    const __m128i other = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('_')), _mm_cmpeq_epi8(v, _mm_set1_epi8('$')));
+                    m = _mm_or_si128(_mm_or_si128(alpha, digit), other);
+                }
+                break;
+            }
+            return unsigned(_mm_movemask_epi8(m));
+        }
+
+        // Same, but for the characters that are present in `chars`.
+        [[nodiscard]] inline unsigned AnyOfMask16(std::string_view chars, const char *ptr)
+        {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ptr));
+            __m128i m = _mm_setzero_si128();
+            for (char ch : chars)
+                m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8(ch)));
+            return unsigned(_mm_movemask_epi8(m));
+        }
+        #endif
+
+        // Returns the length of the longest prefix of `str`, where `CharMatches(c, ...) == expected` for every character.
+        template <CharClass C, bool Expected>
+        [[nodiscard]] constexpr std::size_t RunLength(std::string_view str)
+        {
+            // The runs are usually short, so check the first few characters without loading the whole block.
+            std::size_t i = 0;
+            while (i < 8)
+            {
+                if (i >= str.size() || CharMatches(C, str[i]) != Expected)
+                    return i;
+                i++;
+            }
+
+            #if CPPDECL_SSE2
+            if (!std::is_constant_evaluated())
+            {
+                while (str.size() - i >= 16)
+                {
+                    unsigned mask = CharClassMask16(C, str.data() + i);
+                    if constexpr (Expected)
+                        mask = ~mask & 0xffff;
+                    if (mask)
+                        return i + std::size_t(std::countr_zero(mask));
+                    i += 16;
+                }
+            }
+            #endif
+
+            while (i < str.size() && CharMatches(C, str[i]) == Expected)
+                i++;
+            return i;
+        }
+    }
+
+    // Returns the length of the longest prefix of `str` consisting of `IsWhitespace()` characters.
+    [[nodiscard]] constexpr std::size_t WhitespaceRunLength(std::string_view str)
+    {
+        return detail::StringHelpers::RunLength<detail::StringHelpers::CharClass::whitespace, true>(str);
+    }
+    // Returns the length of the longest prefix of `str` consisting of `IsIdentifierChar()` characters.
+    [[nodiscard]] constexpr std::size_t IdentifierRunLength(std::string_view str)
+    {
+        return detail::StringHelpers::RunLength<detail::StringHelpers::CharClass::identifier, true>(str);
+    }
+    // Returns the length of the longest prefix of `str` consisting of non-`IsIdentifierChar()` characters.
+    [[nodiscard]] constexpr std::size_t NonIdentifierRunLength(std::string_view str)
+    {
+        return detail::StringHelpers::RunLength<detail::StringHelpers::CharClass::identifier, false>(str);
+    }
+
+    // Returns the index of the first character in `str` that is present in `chars`, or `std::string_view::npos` if none.
+    // This is the same as `str.find_first_of(chars)`, but faster for long strings and short `chars`.
+    [[nodiscard]] constexpr std::size_t FindAnyOf(std::string_view str, std::string_view chars)
+    {
+        std::size_t i = 0;
+
+        #if CPPDECL_SSE2
+        if (!std::is_constant_evaluated())
+        {
+            while (str.size() - i >= 16)
+            {
+                if (unsigned mask = detail::StringHelpers::AnyOfMask16(chars, str.data() + i))
+                    return i + std::size_t(std::countr_zero(mask));
+                i += 16;
+            }
+        }
+        #endif
+
+        while (i < str.size())
+        {
+            if (chars.find(str[i]) != std::string_view::npos)
+                return i;
+            i++;
+        }
+        return std::string_view::npos;
+    }
+
+    // Remove any prefix whitespace from `str`.
+    // Returns true if at least one removed.
+    constexpr bool TrimLeadingWhitespace(std::string_view &str)
+    {
+        std::size_t len = WhitespaceRunLength(str);
+        str.remove_prefix(len);
+        return len > 0;
+    }
+    constexpr bool TrimTrailingWhitespace(std::string_view &str)
+    {
+        bool ret = false;
+        while (!str.empty() && IsWhitespace(str.back()))
+        {
+            str.remove_suffix(1);
+            ret = true;
+        }
+        return ret;
+    }
+
+    // --- Keywords:
+
+    // The keywords that the parser needs to recognize. Use `ClassifyKeyword()` to look them up.
+    enum class Keyword : std::uint8_t
+    {
+        none, // Not a keyword (or not one we care about).
+
+        char_,
+        short_,
+        int_,
+        long_,
+        int128, // `__int128`
+        bool_,
+        c_bool, // `_Bool`
+        float_,
+        double_,
+        float128, // `__float128`
+        void_,
+
+        signed_,
+        unsigned_,
+        auto_,
+        c_complex, // `_Complex`
+        c_imaginary, // `_Imaginary`
+
+        const_,
+        volatile_,
+        restrict_, // `restrict`
+        gnu_restrict, // `__restrict`
+        gnu_restrict2, // `__restrict__`
+        msvc_ptr32, // `__ptr32`
+        msvc_ptr64, // `__ptr64`
+        msvc_unaligned, // `__unaligned`
+
+        true_,
+        false_,
+        nullptr_,
+
+        struct_,
+        class_,
+        union_,
+        enum_,
+        typename_,
+    };
+
+    // The categories of a `Keyword`. Those correspond to the `Is...Keyword...()` functions below.
+    enum class KeywordCategories : std::uint16_t
+    {
+        type_integral       = 1 << 0, // `IsTypeNameKeywordIntegral()`
+        type_bool           = 1 << 1, // `IsTypeNameKeywordBool()`
+        type_floating_point = 1 << 2, // `IsTypeNameKeywordFloatingPoint()`
+        type_void           = 1 << 3, // `IsTypeNameKeywordVoid()`
+        type_related        = 1 << 4, // `IsTypeRelatedKeyword()`
+        literal_constant    = 1 << 5, // `IsLiteralConstantKeyword()`
+        type_prefix         = 1 << 6, // `struct`, `class`, etc, `typename`.
+        cv_qualifier        = 1 << 7, // Anything accepted by `ParseCvQualifiers()`.
+    };
+    CPPDECL_FLAG_OPERATORS(KeywordCategories)
+
+    struct KeywordInfo
+    {
+        std::string_view spelling;
+        Keyword id = Keyword::none;
+        KeywordCategories categories{};
+    };
+
+    namespace detail::Keywords
+    {
+        using enum KeywordCategories;
+
+        inline constexpr KeywordInfo list[] = {
+            {"char"       , Keyword::char_         , type_integral | type_related},
+            {"short"      , Keyword::short_        , type_integral | type_related},
+            {"int"        , Keyword::int_          , type_integral | type_related},
+            {"long"       , Keyword::long_         , type_integral | type_related},
+            // Non-standard stuff. This must exist to allow us to parse `unsigned __int128` as a single type rather than as a variable declaration.
+            {"__int128"   , Keyword::int128        , type_integral | type_related},
+            // For simplicity we allow both the normal `bool` and the old C-style `_Bool`.
+            {"bool"       , Keyword::bool_         , type_bool | type_related},
+            {"_Bool"      , Keyword::c_bool        , type_bool | type_related},
+            {"float"      , Keyword::float_        , type_floating_point | type_related},
+            {"double"     , Keyword::double_       , type_floating_point | type_related},
+            // Non-standard stuff. This must exist to allow us to parse `_Complex __float128` as a single type rather than as a variable declaration.
+            {"__float128" , Keyword::float128      , type_floating_point | type_related},
+            {"void"       , Keyword::void_         , type_void | type_related},
+
+            {"signed"     , Keyword::signed_       , type_related},
+            {"unsigned"   , Keyword::unsigned_     , type_related},
+            {"auto"       , Keyword::auto_         , type_related},
+            // Not adding the `complex`/`imaginary` spellings here from `complex.h`, as those would be too prone to name conflicts.
+            {"_Complex"   , Keyword::c_complex     , type_related},
+            {"_Imaginary" , Keyword::c_imaginary   , type_related},
+
+            {"const"      , Keyword::const_        , cv_qualifier | type_related},
+            {"volatile"   , Keyword::volatile_     , cv_qualifier | type_related},
+            // Not marking the C/nonstandard spelling `restrict` as type-related, since that is just for better error messages,
+            //   and the lack of it isn't going to break its parsing or anything.
+            {"restrict"   , Keyword::restrict_     , cv_qualifier},
+            {"__restrict" , Keyword::gnu_restrict  , cv_qualifier | type_related},
+            {"__restrict__", Keyword::gnu_restrict2, cv_qualifier | type_related},
+            {"__ptr32"    , Keyword::msvc_ptr32    , cv_qualifier},
+            {"__ptr64"    , Keyword::msvc_ptr64    , cv_qualifier},
+            {"__unaligned", Keyword::msvc_unaligned, cv_qualifier},
+
+            {"true"       , Keyword::true_         , literal_constant},
+            {"false"      , Keyword::false_        , literal_constant},
+            {"nullptr"    , Keyword::nullptr_      , literal_constant},
+
+            {"struct"     , Keyword::struct_       , type_prefix},
+            {"class"      , Keyword::class_        , type_prefix},
+            {"union"      , Keyword::union_        , type_prefix},
+            {"enum"       , Keyword::enum_         , type_prefix},
+            {"typename"   , Keyword::typename_     , type_prefix},
+        };
+
+        // The keywords are looked up in a perfect hash table. It's generated at compile-time, by trying different seeds until there are no collisions.
+        // The hash only looks at the length and at three characters, which is enough to tell our keywords apart.
+
+        inline constexpr int hash_table_bits = 7;
+
+        // `word` must not be empty.
+        [[nodiscard]] constexpr std::size_t Hash(std::string_view word, std::uint32_t seed)
+        {
+            std::uint32_t ret = seed;
+            for (std::uint32_t x : {std::uint32_t(word.size()), std::uint32_t(std::uint8_t(word.front())), std::uint32_t(std::uint8_t(word[word.size() / 2])), std::uint32_t(std::uint8_t(word.back()))})
+                ret = (ret ^ x) * 0x01000193; // The FNV prime.
+            return ret >> (32 - hash_table_bits);
+        }
+
+        struct HashTable
+        {
+            std::uint32_t seed = 0;
+            // Each element is an index into `list` plus one, or zero if empty.
+            std::array<std::uint8_t, 1 << hash_table_bits> slots{};
+        };
+
+        [[nodiscard]] constexpr HashTable MakeHashTable()
+        {
+            HashTable ret;
+            while (true)
+            {
+                ret.seed++;
+                ret.slots = {};
+
+                bool ok = true;
+                for (std::size_t i = 0; i < std::size(list); i++)
+                {
+                    std::uint8_t &slot = ret.slots[Hash(list[i].spelling, ret.seed)];
+                    if (slot)
+                    {
+                        ok = false;
+                        break;
+                    }
+                    slot = std::uint8_t(i + 1);
+                }
+
+                if (ok)
+                    return ret;
+            }
+        }
+
+        inline constexpr HashTable hash_table = MakeHashTable();
+
+        inline constexpr std::size_t max_length = []{
+            std::size_t ret = 0;
+            for (const KeywordInfo &info : list)
+                ret = std::max(ret, info.spelling.size());
+            return ret;
+        }();
+    }
+
+    // Looks up `word` in the table of keywords above. Returns an empty `KeywordInfo` if this isn't a keyword.
+    // This costs one hash computation and at most one string comparison.
+    [[nodiscard]] constexpr KeywordInfo ClassifyKeyword(std::string_view word)
+    {
+        if (word.empty() || word.size() > detail::Keywords::max_length)
+            return {};
+
+        std::uint8_t slot = detail::Keywords::hash_table.slots[detail::Keywords::Hash(word, detail::Keywords::hash_table.seed)];
+        if (!slot)
+            return {};
+
+        const KeywordInfo &info = detail::Keywords::list[slot - 1];
+        if (info.spelling != word)
+            return {};
+
+        return info;
+    }
+
+    // Returns true if `word` is a keyword in at least one of the `categories`.
+    [[nodiscard]] constexpr bool IsKeywordInCategories(std::string_view word, KeywordCategories categories)
+    {
+        return bool(ClassifyKeyword(word).categories & categories);
+    }
+
     // Is this a name of a built-in integral type?
     // `long long` (a multi-word name) isn't handled here.
     // `bool` also isn't handled here. We check it separately, because unlike those it can't have its signedness set explicitly.
@@ -143,70 +484,40 @@ namespace cppdecl
     //   they don't appear in type names (including standalone, we add `int` ourselves then).
     [[nodiscard]] constexpr bool IsTypeNameKeywordIntegral(std::string_view name)
     {
-        return
-            name == "char" ||
-            name == "short" ||
-            name == "int" ||
-            name == "long" ||
-            name == "__int128"; // Non-standard stuff. This must exist to allow us to parse `unsigned __int128` as a single type rather than as a variable declaration.
+        return IsKeywordInCategories(name, KeywordCategories::type_integral);
     }
 
     // This is a boolean type?
-    // For simplicity we allow both the normal `bool` and the old C-style `_Bool`.
     [[nodiscard]] constexpr bool IsTypeNameKeywordBool(std::string_view name)
     {
-        return
-            name == "bool" ||
-            name == "_Bool";
+        return IsKeywordInCategories(name, KeywordCategories::type_bool);
     }
 
     // Is this a name of a built-in floating-point type?
     // `long double` (a multi-word name) isn't handled here.
     [[nodiscard]] constexpr bool IsTypeNameKeywordFloatingPoint(std::string_view name)
     {
-        return
-            name == "float" ||
-            name == "double" ||
-            name == "__float128"; // Non-standard stuff. This must exist to allow us to parse `_Complex __int128` as a single type rather than as a variable declaration.
+        return IsKeywordInCategories(name, KeywordCategories::type_floating_point);
     }
 
     // Yeah. For consistency.
     [[nodiscard]] constexpr bool IsTypeNameKeywordVoid(std::string_view name)
     {
-        return name == "void";
+        return IsKeywordInCategories(name, KeywordCategories::type_void);
     }
 
     // Is `name` a type or a keyword related to types?
     // We use this to detect clearly invalid variable names that were parsed from types.
     [[nodiscard]] constexpr bool IsTypeRelatedKeyword(std::string_view name)
     {
-        return
-            IsTypeNameKeywordIntegral(name) ||
-            IsTypeNameKeywordBool(name) ||
-            IsTypeNameKeywordFloatingPoint(name) ||
-            IsTypeNameKeywordVoid(name) ||
-            name == "signed" ||
-            name == "unsigned" ||
-            name == "const" ||
-            name == "volatile" ||
-            name == "auto" ||
-            // Not adding the C/nonstandard spelling `restrict` here, since this list is just for better error messages, and the lack of it isn't going
-            //   to break its parsing or anything.
-            name == "__restrict" ||
-            name == "__restrict__" ||
-            // Not adding the `complex`/`imaginary` spellings here from `complex.h`, as those would be too prone to name conflicts.
-            name == "_Complex" ||
-            name == "_Imaginary";
+        return IsKeywordInCategories(name, KeywordCategories::type_related);
     }
 
 
     // Is `name` a keyword that is a literal?
     [[nodiscard]] constexpr bool IsLiteralConstantKeyword(std::string_view name)
     {
-        return
-            name == "true" ||
-            name == "false" ||
-            name == "nullptr";
+        return IsKeywordInCategories(name, KeywordCategories::literal_constant);
     }
 
     // If `input` starts with word `word` (as per `.starts_with()`), removes that prefix and returns true.
@@ -248,6 +559,22 @@ namespace cppdecl
         return ret;
     }
 
+    // Removes the longest prefix of `input` consisting of `IsIdentifierChar()` characters, and returns it.
+    // Doesn't check that the first character is a non-digit.
+    constexpr std::string_view ConsumeIdentifierChars(std::string_view &input)
+    {
+        std::size_t len = IdentifierRunLength(input);
+        std::string_view ret = input.substr(0, len);
+        input.remove_prefix(len);
+        return ret;
+    }
+    // Same, but doesn't modify `input`.
+    // Use this to compare the next word against several keywords in a row, instead of calling `ConsumeWord()` for each of them.
+    [[nodiscard]] constexpr std::string_view PeekIdentifierChars(std::string_view input)
+    {
+        return ConsumeIdentifierChars(input);
+    }
+
 
     enum class ConsumeOperatorTokenFlags
     {
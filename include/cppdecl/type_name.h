@@ -1,5 +1,6 @@
 #pragma once
 
+#include "cppdecl/declarations/parse_mangled.h"
 #include "cppdecl/declarations/parse.h"
 #include "cppdecl/declarations/simplify.h"
 #include "cppdecl/declarations/to_string.h"
@@ -11,12 +12,16 @@
 #endif
 
 #include <array>
+#include <atomic>
 #include <cstddef>
+#include <functional>
+#include <memory>
 #include <stdexcept>
 #include <string_view>
 #include <string>
 #include <typeindex>
 #include <typeinfo> // IWYU pragma: keep, because we do actually use `typeid(T)` in this file.
+#include <utility>
 
 namespace cppdecl
 {
@@ -158,17 +163,43 @@ namespace cppdecl
     // If `flags_simplify` are zero, they default to `native`. To actually avoid simplification, add `no_simplify` to `flags`.
     [[nodiscard]] inline std::string TypeNameDynamic(std::type_index type, TypeNameFlags flags = {}, ToCodeFlags flags_to_code = {}, SimplifyFlags flags_simplify = {})
     {
-        std::string ret = type.name();
         if (bool((flags & TypeNameFlags::no_demangle) == TypeNameFlags::no_demangle))
-            return ret;
+            return type.name();
+
+        Type parsed_type;
 
         #if CPPDECL_NEED_DEMANGLER
-        ret = Demangler{}(ret.c_str());
+        // If we're going to parse the name anyway, try parsing the mangled name directly. This skips the demangler and the second parsing pass.
+        bool parsed_mangled = false;
+        if (!bool((flags & TypeNameFlags::no_process) == TypeNameFlags::no_process))
+        {
+            std::string_view mangled = type.name();
+            auto result = ParseItaniumMangledType(mangled);
+            if (auto mangled_type = std::get_if<Type>(&result); mangled_type && mangled.empty())
+            {
+                parsed_type = std::move(*mangled_type);
+                parsed_mangled = true;
+            }
+        }
+
+        if (!parsed_mangled)
         #endif
-        if (bool((flags & TypeNameFlags::no_process) == TypeNameFlags::no_process))
-            return ret;
+        {
+            std::string ret = type.name();
 
-        Type parsed_type = detail::TypeName::ParseTypeDynamic(ret);
+            #if CPPDECL_NEED_DEMANGLER
+            // Reusing the demangler reuses its buffer between calls.
+            thread_local Demangler demangler;
+            const char *demangled = demangler(ret.c_str());
+            if (!demangled)
+                throw std::runtime_error("cppdecl::TypeNameDynamic(): Unable to demangle `" + ret + "`.");
+            ret = demangled;
+            #endif
+            if (bool((flags & TypeNameFlags::no_process) == TypeNameFlags::no_process))
+                return ret;
+
+            parsed_type = detail::TypeName::ParseTypeDynamic(ret);
+        }
 
         if (!bool(flags & TypeNameFlags::no_simplify))
             (Simplify)(bool(flags_simplify) ? flags_simplify : SimplifyFlags::native, parsed_type);
@@ -176,6 +207,157 @@ namespace cppdecl
         return (ToCode)(parsed_type, flags_to_code);
     }
 
+    // The statistics of the cache used by `TypeNameDynamicCached()`, see `GetTypeNameDynamicCacheStats()`.
+    struct TypeNameDynamicCacheStats
+    {
+        // How many times a name was found in the cache.
+        std::size_t hits = 0;
+        // How many times a name had to be computed. This can be slightly larger than `entries` if several threads race to compute the same name.
+        std::size_t misses = 0;
+        // How many names are stored in the cache.
+        std::size_t entries = 0;
+    };
+
+    namespace detail::TypeName
+    {
+        // The process-wide cache for `TypeNameDynamicCached()`.
+        // This is an insert-only hash table with a fixed number of buckets, each bucket being an atomic singly-linked list.
+        // The entries are immutable once published and are never removed, so the lookups don't need any locks.
+        class DynamicNameCache
+        {
+            struct Entry
+            {
+                std::type_index type;
+                TypeNameFlags flags{};
+                ToCodeFlags flags_to_code{};
+                SimplifyFlags flags_simplify{};
+                std::string name;
+
+                Entry *next = nullptr;
+
+                [[nodiscard]] bool Matches(std::type_index other_type, TypeNameFlags other_flags, ToCodeFlags other_flags_to_code, SimplifyFlags other_flags_simplify) const
+                {
+                    return type == other_type && flags == other_flags && flags_to_code == other_flags_to_code && flags_simplify == other_flags_simplify;
+                }
+            };
+
+            static constexpr std::size_t num_buckets = 256;
+            std::array<std::atomic<Entry *>, num_buckets> buckets{};
+
+            // The hits are counted on every lookup, so a single shared counter would make the threads contend for its cache line.
+            // Instead we have several counters, each on its own cache line, and each thread uses one of them. `GetStats()` sums them.
+            // 64 is the cache line size on all common platforms. We don't use `std::hardware_destructive_interference_size`, because GCC warns that it's not ABI-stable.
+            struct alignas(64) HitCounter
+            {
+                std::atomic<std::size_t> value = 0;
+            };
+            static constexpr std::size_t num_hit_counters = 16;
+            std::array<HitCounter, num_hit_counters> hit_counters{};
+
+            std::atomic<std::size_t> num_misses = 0;
+            std::atomic<std::size_t> num_entries = 0;
+
+            // Returns the counter in `hit_counters` for the current thread. The threads are assigned to the counters round-robin when they first get here.
+            [[nodiscard]] std::atomic<std::size_t> &ThisThreadHitCounter()
+            {
+                static std::atomic<std::size_t> next_index = 0;
+                thread_local const std::size_t index = next_index.fetch_add(1, std::memory_order_relaxed) % num_hit_counters;
+                return hit_counters[index].value;
+            }
+
+            // Searches the list starting at `begin`, until reaching `end` (which is either null or a node from the same list).
+            [[nodiscard]] static const Entry *Find(const Entry *begin, const Entry *end, std::type_index type, TypeNameFlags flags, ToCodeFlags flags_to_code, SimplifyFlags flags_simplify)
+            {
+                for (const Entry *entry = begin; entry != end; entry = entry->next)
+                {
+                    if (entry->Matches(type, flags, flags_to_code, flags_simplify))
+                        return entry;
+                }
+                return nullptr;
+            }
+
+          public:
+            DynamicNameCache() {}
+            DynamicNameCache(const DynamicNameCache &) = delete;
+            DynamicNameCache &operator=(const DynamicNameCache &) = delete;
+            ~DynamicNameCache()
+            {
+                for (std::atomic<Entry *> &bucket : buckets)
+                {
+                    Entry *entry = bucket.load(std::memory_order_relaxed);
+                    while (entry)
+                        delete std::exchange(entry, entry->next);
+                }
+            }
+
+            [[nodiscard]] static DynamicNameCache &Get()
+            {
+                static DynamicNameCache ret;
+                return ret;
+            }
+
+            // If the name isn't in the cache yet, calls `make_name()` to compute it.
+            // That happens without holding any locks, so several threads can compute the same name at the same time, then all but one of them discard their results.
+            template <typename F>
+            [[nodiscard]] const std::string &FindOrInsert(std::type_index type, TypeNameFlags flags, ToCodeFlags flags_to_code, SimplifyFlags flags_simplify, F &&make_name)
+            {
+                std::size_t hash = std::hash<std::type_index>{}(type);
+                hash ^= std::size_t(flags) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+                hash ^= std::size_t(flags_to_code) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+                hash ^= std::size_t(flags_simplify) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+
+                std::atomic<Entry *> &bucket = buckets[hash % num_buckets];
+
+                Entry *head = bucket.load(std::memory_order_acquire);
+                if (const Entry *entry = Find(head, nullptr, type, flags, flags_to_code, flags_simplify))
+                {
+                    ThisThreadHitCounter().fetch_add(1, std::memory_order_relaxed);
+                    return entry->name;
+                }
+
+                num_misses.fetch_add(1, std::memory_order_relaxed);
+
+                std::unique_ptr<Entry> new_entry(new Entry{type, flags, flags_to_code, flags_simplify, std::forward<F>(make_name)(), head});
+
+                // On failure, this updates `new_entry->next` to the new head of the list.
+                while (!bucket.compare_exchange_weak(new_entry->next, new_entry.get(), std::memory_order_release, std::memory_order_acquire))
+                {
+                    // Only need to check the entries that were added since we last looked.
+                    if (const Entry *entry = Find(new_entry->next, head, type, flags, flags_to_code, flags_simplify))
+                        return entry->name;
+                    head = new_entry->next;
+                }
+
+                num_entries.fetch_add(1, std::memory_order_relaxed);
+                return new_entry.release()->name;
+            }
+
+            [[nodiscard]] TypeNameDynamicCacheStats GetStats() const
+            {
+                TypeNameDynamicCacheStats ret;
+                for (const HitCounter &counter : hit_counters)
+                    ret.hits += counter.value.load(std::memory_order_relaxed);
+                ret.misses = num_misses.load(std::memory_order_relaxed);
+                ret.entries = num_entries.load(std::memory_order_relaxed);
+                return ret;
+            }
+        };
+    }
+
+    // Same as `TypeNameDynamic()`, but caches the results in a process-wide cache, keyed by all the parameters.
+    // Once a name is in the cache, this doesn't lock or allocate, so it's cheap to call from many threads at once.
+    // The returned reference remains valid until the program exits.
+    [[nodiscard]] inline const std::string &TypeNameDynamicCached(std::type_index type, TypeNameFlags flags = {}, ToCodeFlags flags_to_code = {}, SimplifyFlags flags_simplify = {})
+    {
+        return detail::TypeName::DynamicNameCache::Get().FindOrInsert(type, flags, flags_to_code, flags_simplify, [&]{return (TypeNameDynamic)(type, flags, flags_to_code, flags_simplify);});
+    }
+
+    // Returns the statistics of the cache used by `TypeNameDynamicCached()`.
+    [[nodiscard]] inline TypeNameDynamicCacheStats GetTypeNameDynamicCacheStats()
+    {
+        return detail::TypeName::DynamicNameCache::Get().GetStats();
+    }
+
     namespace detail::TypeName
     {
         // We need a separate function instead of doing this directly in `TypeName()`,
@@ -183,7 +365,7 @@ namespace cppdecl
         template <typename T, TypeNameFlags Flags, ToCodeFlags Flags_ToCode, SimplifyFlags Flags_Simplify>
         static const std::string &CachedDynamicName()
         {
-            static const std::string ret = (TypeNameDynamic)(typeid(T), Flags, Flags_ToCode, Flags_Simplify);
+            static const std::string &ret = (TypeNameDynamicCached)(typeid(T), Flags, Flags_ToCode, Flags_Simplify);
             return ret;
         }
     }
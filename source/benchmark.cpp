@@ -0,0 +1,265 @@
+// A small benchmark for the parser. For each input, prints how many heap allocations a single parse performs, and how long it takes.
+// The allocations are printed twice, the second time when reusing a `ParseContext` that was already used for the same input.
+// The time is measured with a reused context.
+// The time is printed twice, the second time with `ParseTypeFlags::no_fast_path`, to show the effect of the fast path for the simple types.
+// Run without arguments to use the built-in corpus, or pass your own types as arguments.
+// With the built-in corpus, this also checks that the parsing time grows linearly with the number of function parameters,
+//   and that the limits bound the time spent on the nested ambiguous declarators.
+
+#include "cppdecl/declarations/parse.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// GCC sees the `std::free()` calls below paired with `operator new` after inlining, and thinks it's a mismatch.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+static std::size_t num_allocations = 0;
+
+void *operator new(std::size_t size)
+{
+    num_allocations++;
+    if (void *ret = std::malloc(size ? size : 1))
+        return ret;
+    throw std::bad_alloc{};
+}
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+// Some typical type names, mostly the way compilers spell them.
+static const std::string_view default_corpus[] = {
+    "int",
+    "unsigned long long",
+    "const char *",
+    "const char *const *",
+    "int &&",
+    "int[42]",
+    "void (*)(int, float)",
+    "std::vector<int>",
+    "std::vector<int, std::allocator<int> >",
+    "std::__cxx11::basic_string<char, std::char_traits<char>, std::allocator<char> >",
+    "std::map<std::__cxx11::basic_string<char, std::char_traits<char>, std::allocator<char> >, int, std::less<std::__cxx11::basic_string<char, std::char_traits<char>, std::allocator<char> > >, std::allocator<std::pair<const std::__cxx11::basic_string<char, std::char_traits<char>, std::allocator<char> >, int> > >",
+    "std::unique_ptr<MyNamespace::MyClass, std::default_delete<MyNamespace::MyClass> >",
+    "std::array<int, 42>",
+    "int MyClass::*",
+    "void (MyClass::*)(int) const &",
+    // Nested ambiguous declarators. Each level can be either a parameter name in parentheses or a function type,
+    //   so this used to take exponential time to parse.
+    "int(a(b(c(d))))",
+    "int(a(b(c(d(e(f(g(h(i(j))))))))))",
+};
+
+struct Result
+{
+    bool ok = false;
+    std::size_t allocations = 0;
+    std::size_t allocations_with_reused_context = 0;
+    double nanoseconds = 0;
+    double nanoseconds_without_fast_path = 0;
+};
+
+// Keeps parsing until enough time passes, returns the average time per parse.
+static double MeasureTime(std::string_view input, cppdecl::ParseTypeFlags flags)
+{
+    using clock = std::chrono::steady_clock;
+
+    std::size_t num_iterations = 0;
+    clock::time_point start = clock::now();
+    clock::duration elapsed{};
+
+    cppdecl::ParseContext context;
+
+    do
+    {
+        for (int i = 0; i < 100; i++)
+        {
+            std::string_view input_copy = input;
+            auto result = cppdecl::ParseType(input_copy, flags, context);
+            (void)result;
+        }
+        num_iterations += 100;
+        elapsed = clock::now() - start;
+    }
+    while (elapsed < std::chrono::milliseconds(200));
+
+    return double(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / double(num_iterations);
+}
+
+static Result Benchmark(std::string_view input)
+{
+    Result ret;
+
+    { // Count the allocations of a single parse.
+        std::string_view input_copy = input;
+        std::size_t allocations_before = num_allocations;
+        auto result = cppdecl::ParseType(input_copy);
+        ret.allocations = num_allocations - allocations_before;
+        ret.ok = !std::holds_alternative<cppdecl::ParseError>(result) && input_copy.empty();
+    }
+
+    { // Same, but with a context that was already used once, so it has the temporary storage ready.
+        cppdecl::ParseContext context;
+        for (int i = 0; i < 2; i++)
+        {
+            std::string_view input_copy = input;
+            std::size_t allocations_before = num_allocations;
+            auto result = cppdecl::ParseType(input_copy, {}, context);
+            (void)result;
+            ret.allocations_with_reused_context = num_allocations - allocations_before;
+        }
+    }
+
+    ret.nanoseconds = MeasureTime(input, {});
+    ret.nanoseconds_without_fast_path = MeasureTime(input, cppdecl::ParseTypeFlags::no_fast_path);
+
+    return ret;
+}
+
+// Returns the best time of a few parses of `void(int (x0), int (x1), ...)` with `num_params` parameters, in nanoseconds.
+// The parentheses make each parameter ambiguous, so this exercises the memoization of the nested `ParseDecl()` calls.
+static double MeasureManyParams(std::size_t num_params)
+{
+    std::string input = "void(";
+    for (std::size_t i = 0; i < num_params; i++)
+    {
+        if (i > 0)
+            input += ", ";
+        input += "int (x" + std::to_string(i) + ")";
+    }
+    input += ")";
+
+    using clock = std::chrono::steady_clock;
+    clock::duration best = clock::duration::max();
+    cppdecl::ParseContext context;
+    for (int i = 0; i < 5; i++)
+    {
+        std::string_view input_copy = input;
+        clock::time_point start = clock::now();
+        auto result = cppdecl::ParseType(input_copy, {}, context);
+        clock::duration elapsed = clock::now() - start;
+        if (std::holds_alternative<cppdecl::ParseError>(result) || !input_copy.empty())
+        {
+            std::printf("Failed to parse the type with %zu parameters.\n", num_params);
+            std::exit(1);
+        }
+        if (elapsed < best)
+            best = elapsed;
+    }
+
+    return double(std::chrono::duration_cast<std::chrono::nanoseconds>(best).count());
+}
+
+// Returns the best time of a few parses of `int(x0(x1(...(xN))))` with `depth` nested names, in nanoseconds.
+// The number of interpretations of this grows exponentially with the depth, so we set the limits, which should make the time bounded.
+// Writes the parse error (if any) to `error`.
+static double MeasureNested(std::size_t depth, const char *&error)
+{
+    std::string input = "int(";
+    for (std::size_t i = 0; i < depth; i++)
+        input += "x" + std::to_string(i) + (i + 1 < depth ? "(" : "");
+    input += std::string(depth, ')');
+
+    using clock = std::chrono::steady_clock;
+    clock::duration best = clock::duration::max();
+    cppdecl::ParseContext context{.limits = {.max_nodes = 100000, .max_alternatives = 10000}};
+    for (int i = 0; i < 5; i++)
+    {
+        std::string_view input_copy = input;
+        clock::time_point start = clock::now();
+        auto result = cppdecl::ParseDecl(input_copy, cppdecl::ParseDeclFlags::accept_everything, context);
+        clock::duration elapsed = clock::now() - start;
+        auto parse_error = std::get_if<cppdecl::ParseError>(&result);
+        error = parse_error ? parse_error->message : nullptr;
+        if (elapsed < best)
+            best = elapsed;
+    }
+
+    return double(std::chrono::duration_cast<std::chrono::nanoseconds>(best).count());
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<std::string_view> corpus;
+    if (argc > 1)
+        corpus.assign(argv + 1, argv + argc);
+    else
+        corpus.assign(std::begin(default_corpus), std::end(default_corpus));
+
+    std::size_t total_allocations = 0;
+    std::size_t total_allocations_with_reused_context = 0;
+    double total_nanoseconds = 0;
+    double total_nanoseconds_without_fast_path = 0;
+
+    std::printf("%8s %8s %12s %12s  %s\n", "allocs", "reused", "ns/parse", "no fast path", "input");
+    for (std::string_view input : corpus)
+    {
+        Result result = Benchmark(input);
+        total_allocations += result.allocations;
+        total_allocations_with_reused_context += result.allocations_with_reused_context;
+        total_nanoseconds += result.nanoseconds;
+        total_nanoseconds_without_fast_path += result.nanoseconds_without_fast_path;
+        std::printf("%8zu %8zu %12.0f %12.0f  %.*s%s\n", result.allocations, result.allocations_with_reused_context, result.nanoseconds, result.nanoseconds_without_fast_path, int(input.size()), input.data(), result.ok ? "" : "  (PARSE ERROR)");
+    }
+    std::printf("%8zu %8zu %12.0f %12.0f  total\n", total_allocations, total_allocations_with_reused_context, total_nanoseconds, total_nanoseconds_without_fast_path);
+
+    if (argc > 1)
+        return 0;
+
+    // Check that the time per parameter doesn't grow with the number of parameters.
+    // We allow some slack for the cache effects and the timer noise.
+    std::printf("\n%8s %12s %12s\n", "params", "ms/parse", "ns/param");
+    double first_ns_per_param = 0;
+    double last_ns_per_param = 0;
+    for (std::size_t num_params : {1000, 4000, 16000})
+    {
+        double ns = MeasureManyParams(num_params);
+        last_ns_per_param = ns / double(num_params);
+        if (first_ns_per_param == 0)
+            first_ns_per_param = last_ns_per_param;
+        std::printf("%8zu %12.2f %12.0f\n", num_params, ns / 1e6, last_ns_per_param);
+    }
+    if (last_ns_per_param > first_ns_per_param * 3)
+    {
+        std::printf("The time per parameter grows with the number of parameters, the parsing is superlinear!\n");
+        return 1;
+    }
+
+    // The nested ambiguous declarators take exponential time (see `known_issues.md`), but the limits should stop them early.
+    // Check that once the limits are hit, the time stops growing with the depth.
+    std::printf("\n%8s %12s  %s\n", "depth", "ms/parse", "result");
+    double limited_ns = 0;
+    for (std::size_t depth : {8, 16, 32, 64, 128})
+    {
+        const char *error = nullptr;
+        double ns = MeasureNested(depth, error);
+        std::printf("%8zu %12.2f  %s\n", depth, ns / 1e6, error ? error : "ok");
+        if (!error)
+            continue;
+        if (limited_ns == 0)
+            limited_ns = ns;
+        else if (ns > limited_ns * 3)
+        {
+            std::printf("The time keeps growing after exceeding the limits, they don't bound the work!\n");
+            return 1;
+        }
+    }
+    if (limited_ns == 0)
+    {
+        std::printf("Expected the deeply nested declarators to exceed the limits.\n");
+        return 1;
+    }
+}
@@ -49,8 +49,11 @@ int main()
 
             if (!prefix_len)
             {
-                out += line_view.front();
-                line_view.remove_prefix(1);
+                // Copy everything up to the next character that can start one of those prefixes.
+                std::size_t len = cppdecl::FindAnyOf(line_view.substr(1), "'=\xC2");
+                len = len == std::string_view::npos ? line_view.size() : len + 1;
+                out += line_view.substr(0, len);
+                line_view.remove_prefix(len);
                 continue;
             }
 
@@ -149,17 +152,10 @@ int main()
             if (std::holds_alternative<cppdecl::ParseError>(result) || !part_to_parse.starts_with(expected_suffix))
             {
                 // Skip this block of identifier characters, followed by any punctuation.
-                while (!line_view.empty() && cppdecl::IsIdentifierChar(line_view.front()))
-                {
-                    out += line_view.front();
-                    line_view.remove_prefix(1);
-                }
-                // Now the punctuation...
-                while (!line_view.empty() && !cppdecl::IsIdentifierChar(line_view.front()))
-                {
-                    out += line_view.front();
-                    line_view.remove_prefix(1);
-                }
+                std::size_t len = cppdecl::IdentifierRunLength(line_view);
+                len += cppdecl::NonIdentifierRunLength(line_view.substr(len));
+                out += line_view.substr(0, len);
+                line_view.remove_prefix(len);
 
                 continue;
             }
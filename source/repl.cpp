@@ -1,18 +1,58 @@
 // This is a small demo of the library, an interactive REPL-style type parser and simplifier.
+// Pass `--stats` as the first argument to also print the parser statistics (see `ParseStats`) and the number of heap allocations for each input.
+
+// Enable collecting `ParseStats`. They are only printed with `--stats`.
+#define CPPDECL_PARSE_STATS 1
 
 #include "cppdecl/declarations/parse.h"
 #include "cppdecl/declarations/simplify.h"
 #include "cppdecl/declarations/to_string.h"
 #include "cppdecl/type_name.h"
 
+#include <cstddef>
+#include <cstdlib>
 #include <iostream>
+#include <new>
 #include <string>
+#include <string_view>
 
-int main(int argc, char **argv)
+// GCC sees the `std::free()` calls below paired with `operator new` after inlining, and thinks it's a mismatch.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+static std::size_t num_allocations = 0;
+
+void *operator new(std::size_t size)
+{
+    num_allocations++;
+    if (void *ret = std::malloc(size ? size : 1))
+        return ret;
+    throw std::bad_alloc{};
+}
+void operator delete(void *ptr) noexcept
 {
-    bool use_argv = argc > 1;
+    std::free(ptr);
+}
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
 
+int main(int argc, char **argv)
+{
     int i = 1;
+
+    bool print_stats = false;
+    if (i < argc && std::string_view(argv[i]) == "--stats")
+    {
+        print_stats = true;
+        i++;
+    }
+
+    const int first_input = i;
+    bool use_argv = argc > first_input;
+
     std::string line;
 
     while (true)
@@ -23,7 +63,7 @@ int main(int argc, char **argv)
         {
             if (i >= argc)
                 break;
-            std::cout << i << ". ";
+            std::cout << i - first_input + 1 << ". ";
         }
 
         std::cout << "Declaration to parse:\n";
@@ -41,7 +81,15 @@ int main(int argc, char **argv)
         }
 
         std::string_view input = input_ptr;
-        auto ret = cppdecl::ParseDecl(input, cppdecl::ParseDeclFlags::accept_everything);
+
+        cppdecl::ParseStats stats;
+        cppdecl::ParseContext context;
+        if (print_stats)
+            context.stats = &stats;
+
+        const std::size_t num_allocations_before = num_allocations;
+        auto ret = cppdecl::ParseDecl(input, cppdecl::ParseDeclFlags::accept_everything, context);
+        const std::size_t num_parse_allocations = num_allocations - num_allocations_before;
 
         if (!input.empty() || std::holds_alternative<cppdecl::ParseError>(ret))
         {
@@ -73,5 +121,18 @@ int main(int argc, char **argv)
                 std::cout << cppdecl::ToString(simplified_decl, {}) << '\n';
             }
         }
+
+        if (print_stats)
+        {
+            std::cout << "\n--- Parser stats:\n";
+            std::cout << "Nodes:                 " << context.num_nodes << '\n';
+            std::cout << "Candidates:            " << stats.candidates << '\n';
+            std::cout << "Backtracks:            " << stats.backtracks << '\n';
+            std::cout << "`(` backups:           " << stats.open_paren_backups << '\n';
+            std::cout << "Nested `ParseDecl()`:  " << stats.decl_reentries << " (" << stats.decl_memo_hits << " from memo)\n";
+            std::cout << "Expression fallbacks:  " << stats.pseudo_expr_fallbacks << '\n';
+            std::cout << "Bytes scanned:         " << stats.bytes_scanned << '\n';
+            std::cout << "Heap allocations:      " << num_parse_allocations << '\n';
+        }
     }
 }
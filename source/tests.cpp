@@ -1,15 +1,30 @@
+// Enable collecting `ParseStats`, to test them.
+#define CPPDECL_PARSE_STATS 1
+
+#include "cppdecl/declarations/flat.h"
+#include "cppdecl/declarations/hash.h"
+#include "cppdecl/declarations/measure.h"
+#include "cppdecl/declarations/parse_mangled.h"
 #include "cppdecl/declarations/parse_simple.h"
 #include "cppdecl/declarations/parse.h"
+#include "cppdecl/declarations/parse_view.h"
 #include "cppdecl/declarations/simplify_modules/phmap.h"
 #include "cppdecl/declarations/simplify.h"
 #include "cppdecl/declarations/to_string.h"
+#include "cppdecl/declarations/type_table.h"
+#include "cppdecl/misc/identifier_table.h"
 #include "cppdecl/type_name.h"
 
+#include <array>
 #include <iostream>
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <typeindex>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 
 void Fail(std::string_view message)
@@ -440,6 +455,8 @@ int main()
     CheckParseSuccess("int(x)",                                cppdecl::ParseDeclFlags::accept_all_named        , R"({type="{attrs=[],flags=[],quals=[],name={global_scope=false,parts=[{name="int"}]}}",name="{global_scope=false,parts=[{name="x"}]}"})");
     // Triple ambiguity (two alternatives on the top level, then another two in one of the function parameters).
     CheckParseSuccess("x(y(z))",                               m_any | cppdecl::ParseDeclFlags::force_non_empty_return_type, R"(either [{type="a function taking 1 parameter: [either [{type="a function taking 1 parameter: [{type="{attrs=[],flags=[],quals=[],name={global_scope=false,parts=[{name="z"}]}}",name="{global_scope=false,parts=[]}"}], returning {attrs=[],flags=[],quals=[],name={global_scope=false,parts=[{name="y"}]}}",name="{global_scope=false,parts=[]}"}] or [{type="{attrs=[],flags=[],quals=[],name={global_scope=false,parts=[{name="y"}]}}",name="{global_scope=false,parts=[{name="z"}]}"}]], returning {attrs=[],flags=[],quals=[],name={global_scope=false,parts=[{name="x"}]}}",name="{global_scope=false,parts=[]}"}] or [{type="a function taking 1 parameter: [{type="{attrs=[],flags=[],quals=[],name={global_scope=false,parts=[{name="z"}]}}",name="{global_scope=false,parts=[]}"}], returning {attrs=[],flags=[],quals=[],name={global_scope=false,parts=[{name="x"}]}}",name="{global_scope=false,parts=[{name="y"}]}"}])");
+    // Deeper nesting. The inner parameters are reparsed for every candidate of the outer ones, this exercises the memoization of those reparses.
+    CheckParseSuccess("int(a(b(c)))",                          m_any, "ambiguous, either [unnamed function taking 1 parameter: [ambiguous, either [unnamed function taking 1 parameter: [ambiguous, either [unnamed function taking 1 parameter: [unnamed of type `c`], returning `b`] or [`c` of type `b`]], returning `a`] or [`b`, a function taking 1 parameter: [unnamed of type `c`], returning `a`]], returning `int`] or [`a`, a function taking 1 parameter: [ambiguous, either [unnamed function taking 1 parameter: [unnamed of type `c`], returning `b`] or [`c` of type `b`]], returning `int`]", cppdecl::ToStringFlags{});
 
     // C-style variadics.
     CheckParseSuccess("int(...)",                              m_any, R"({type="a function taking no parameters and a C-style variadic parameter, returning {attrs=[],flags=[],quals=[],name={global_scope=false,parts=[{name="int"}]}}",name="{global_scope=false,parts=[]}"})");
@@ -1846,6 +1863,37 @@ int main()
     // Check that simplification handles the numbers correclty.
     CheckTypeRoundtrip("A<4'2, 1'2.e0'0>", "A<42, 12.0>", {}, cppdecl::SimplifyFlags::bit_common_normalize_numbers);
 
+    { // The simplification is done structurally, make sure it matches printing and parsing the number again.
+        for (std::string_view str : {
+            "0", "42", "4'2", "0'7", "0x1'aB", "0b1'01", "42ull", "42_foo",
+            "1.", ".1", "1.5", "1'2.3'4", "1.e0'0", "1.5e0", "1.5e+00", "1.5e-0", "1e5", "1e+5", "1e-5", "1.0e5", "1.00e-5", "0.e0", "12.0'0e0'0",
+            "0x1p3", "0x1.p0", "0x1.0p+0", "0xa.Bp-1", "1.5f", "1e5_bar", "01.5", "09.5",
+        })
+        {
+            std::string_view input = str;
+            auto result = cppdecl::ParseNumericLiteral(input);
+            auto lit = std::get_if<std::optional<cppdecl::NumericLiteral>>(&result);
+            if (!lit || !*lit || !input.empty())
+            {
+                Fail("Unable to parse numeric literal: " + std::string(str));
+                continue;
+            }
+
+            cppdecl::NumericLiteral simplified = **lit;
+            cppdecl::DefaultSimplifyTraits{}.SimplifyNumericLiteral(cppdecl::SimplifyFlags::bit_common_normalize_numbers, simplified);
+
+            std::string expected_str = cppdecl::ToCode(**lit, cppdecl::ToCodeFlags::weakly_canonical_language_agnostic);
+            std::string_view expected_view = expected_str;
+            auto expected = cppdecl::ParseNumericLiteral(expected_view);
+            if (!expected_view.empty() || std::get<std::optional<cppdecl::NumericLiteral>>(expected) != simplified)
+                Fail("Numeric literal simplification for `" + std::string(str) + "` doesn't match the roundtrip through `" + expected_str + "`, got `" + cppdecl::ToCode(simplified, {}) + "`.");
+
+            // The cached value must match the one decoded from scratch.
+            if (auto i = std::get_if<cppdecl::NumericLiteral::Integer>(&simplified.var); i && i->cached_value != cppdecl::NumericLiteral::Integer::DecodeValue(i->base, i->value))
+                Fail("Wrong cached value for numeric literal `" + std::string(str) + "`.");
+        }
+    }
+
 
     // Unspellable types.
     auto TestUnspellableType = [&](std::string str)
@@ -1955,6 +2003,850 @@ int main()
     CheckActualEqualsExpected("", cppdecl::TypeName<int, cppdecl::TypeNameFlags::use_typeid | cppdecl::TypeNameFlags::no_demangle>(), "i");
     #endif
 
+    { // The cache for dynamic type names.
+        auto stats_before = cppdecl::GetTypeNameDynamicCacheStats();
+        const std::string &name = cppdecl::TypeNameDynamicCached(typeid(std::unordered_map<int, float>::iterator));
+        CheckActualEqualsExpected("", name, "std::unordered_map<int, float>::iterator");
+        const std::string &name2 = cppdecl::TypeNameDynamicCached(typeid(std::unordered_map<int, float>::iterator));
+        if (&name != &name2)
+            Fail("Expected the cached name to be reused.");
+        CheckActualEqualsExpected("", cppdecl::TypeNameDynamicCached(typeid(std::unordered_map<int, float>::iterator), cppdecl::TypeNameFlags::no_simplify), cppdecl::TypeNameDynamic(typeid(std::unordered_map<int, float>::iterator), cppdecl::TypeNameFlags::no_simplify));
+        auto stats_after = cppdecl::GetTypeNameDynamicCacheStats();
+        if (stats_after.hits != stats_before.hits + 1 || stats_after.misses != stats_before.misses + 2 || stats_after.entries != stats_before.entries + 2)
+            Fail("Wrong cache statistics.");
+
+        // Many threads racing to fill the cache must agree on the same strings.
+        const std::type_index types[] = {typeid(std::vector<int>), typeid(std::unordered_set<float>), typeid(std::string_view), typeid(std::runtime_error)};
+        constexpr std::size_t num_types = std::size(types);
+        constexpr std::size_t num_threads = 8;
+        constexpr std::size_t num_iterations = 1000;
+        std::array<std::array<const std::string *, num_types>, num_threads> results{};
+        {
+            std::vector<std::thread> threads;
+            for (std::size_t i = 0; i < num_threads; i++)
+            {
+                threads.emplace_back([&, i]
+                {
+                    for (std::size_t j = 0; j < num_iterations; j++)
+                    {
+                        for (std::size_t k = 0; k < num_types; k++)
+                            results[i][k] = &cppdecl::TypeNameDynamicCached(types[(k + i) % num_types]);
+                    }
+                });
+            }
+            for (std::thread &thread : threads)
+                thread.join();
+        }
+        // Every lookup is counted exactly once, either as a hit or as a miss, even though the hits are counted per thread.
+        auto stats_threads = cppdecl::GetTypeNameDynamicCacheStats();
+        if ((stats_threads.hits + stats_threads.misses) - (stats_after.hits + stats_after.misses) != num_threads * num_iterations * num_types)
+            Fail("Wrong cache statistics after the concurrent lookups.");
+        for (std::size_t i = 0; i < num_threads; i++)
+        {
+            for (std::size_t k = 0; k < num_types; k++)
+            {
+                const std::string *expected = &cppdecl::TypeNameDynamicCached(types[(k + i) % num_types]);
+                if (results[i][k] != expected)
+                    Fail("Expected all threads to get the same cached name.");
+                CheckActualEqualsExpected("", *expected, cppdecl::TypeNameDynamic(types[(k + i) % num_types]));
+            }
+        }
+        if (cppdecl::GetTypeNameDynamicCacheStats().entries != stats_after.entries + num_types)
+            Fail("Expected each name to be cached exactly once.");
+    }
+
+
+    { // Identifier interning.
+        cppdecl::IdentifierTable table;
+        cppdecl::Identifier a = table.Intern("basic_string");
+        cppdecl::Identifier b = table.Intern("allocator");
+        if (!a || !b || a == b || table.Intern("basic_string") != a || table.Find("allocator") != b || table.Find("vector") || table.size() != 2)
+            Fail("Wrong identifier interning behavior.");
+        CheckActualEqualsExpected("", table[a], "basic_string");
+        CheckActualEqualsExpected("", table[b], "allocator");
+    }
+
+
+    { // Hash-consed types.
+        cppdecl::TypeTable table;
+        cppdecl::Type map_type = cppdecl::ParseType_Simple("std::map<std::vector<int>, std::vector<int>, std::less<std::vector<int>>> *");
+        cppdecl::InternedType a = table.Intern(map_type);
+        cppdecl::InternedType b = table.Intern(cppdecl::ParseType_Simple("std::map<std::vector<int>, std::vector<int>, std::less<std::vector<int>>> *"));
+        cppdecl::InternedType c = table.Intern(cppdecl::ParseType_Simple("std::map<std::vector<int>, std::vector<int>, std::less<std::vector<int>>>"));
+        if (a != b || a == c || a.Hash() != b.Hash())
+            Fail("Wrong hash-consing behavior.");
+        if (a.ToType() != map_type)
+            Fail("Interned type doesn't roundtrip.");
+        // The identical template arguments are shared.
+        if (a.TypeArgs().size() != 3 || a.TypeArgs()[0] != a.TypeArgs()[1] || a.TypeArgs()[2].TypeArgs().front() != a.TypeArgs()[0])
+            Fail("Wrong template arguments of an interned type.");
+        if (a.TypeArgs()[0] != c.TypeArgs()[0])
+            Fail("Wrong template arguments of an interned type.");
+        // Types: `std::map<...> *`, `std::map<...>`, `std::vector<int>`, `int`, `std::less<...>`.
+        if (table.size() != 5)
+            Fail("Wrong number of interned types.");
+        // The name words are interned too.
+        if (a.NameWords().size() != 2 || a.NameWords()[0] != table.Identifiers().Find("std") || a.NameWords()[1] != table.Identifiers().Find("map"))
+            Fail("Wrong name words of an interned type.");
+    }
+
+    { // Structural hashing.
+        auto HashOf = [](std::string_view str, cppdecl::HashFlags flags = {}){return cppdecl::Hash(cppdecl::ParseType_Simple(str), flags);};
+
+        if (HashOf("std::vector<int> *") != HashOf("std::vector<int> *") || HashOf("std::vector<int> *") == HashOf("std::vector<int>"))
+            Fail("Wrong structural hash.");
+        if (HashOf("int") == HashOf("const int") || HashOf("int *") == HashOf("int *const") || HashOf("A<int>") == HashOf("A"))
+            Fail("Wrong structural hash.");
+
+        // Those agree with the `Equals()` flags.
+        if (HashOf("const int", cppdecl::HashFlags::ignore_top_level_const) != HashOf("int", cppdecl::HashFlags::ignore_top_level_const))
+            Fail("Wrong structural hash with `ignore_top_level_const`.");
+        if (HashOf("int *const", cppdecl::HashFlags::ignore_top_level_const) != HashOf("int *", cppdecl::HashFlags::ignore_top_level_const))
+            Fail("Wrong structural hash with `ignore_top_level_const`.");
+        if (HashOf("const int *", cppdecl::HashFlags::ignore_top_level_const) == HashOf("int *", cppdecl::HashFlags::ignore_top_level_const))
+            Fail("Wrong structural hash with `ignore_top_level_const`.");
+        if (HashOf("std::vector<int>", cppdecl::HashFlags::ignore_final_template_args) != HashOf("std::vector", cppdecl::HashFlags::ignore_final_template_args))
+            Fail("Wrong structural hash with `ignore_final_template_args`.");
+        if (HashOf("A<int>::B", cppdecl::HashFlags::ignore_final_template_args) == HashOf("A::B", cppdecl::HashFlags::ignore_final_template_args))
+            Fail("Wrong structural hash with `ignore_final_template_args`.");
+
+        // Can be used in the standard containers.
+        std::unordered_set<cppdecl::Type> set;
+        set.insert(cppdecl::ParseType_Simple("std::map<int, float>"));
+        set.insert(cppdecl::ParseType_Simple("std::map<int, float>"));
+        set.insert(cppdecl::ParseType_Simple("void (*)(int x)"));
+        if (set.size() != 2 || !set.contains(cppdecl::ParseType_Simple("void (*)(int x)")))
+            Fail("Structural hashing doesn't work in containers.");
+
+        std::unordered_set<cppdecl::HashedNode<cppdecl::Type>> hashed_set;
+        cppdecl::HashedNode<cppdecl::Type> hashed_type = cppdecl::ParseType_Simple("std::map<int, float>");
+        hashed_set.insert(hashed_type);
+        if (hashed_type.Hash() != cppdecl::Hash(*hashed_type) || !hashed_set.contains(hashed_type))
+            Fail("Wrong cached hash.");
+    }
+
+    { // Flat trees.
+        for (std::string_view str : {
+            "int",
+            "const unsigned long long int *volatile &&",
+            "std::map<std::vector<int>, float(*)[42]> A::*",
+            "void (*)(int x, float, ...) const & noexcept",
+            "auto() -> int",
+            "A<1'000ull, 1.5e+3f, .5_x, 0x1p3, \"foo\"_bar, u8R\"abc(x)abc\", (1, {2, 3,}), [4], B<C>{}>",
+            "__attribute__((foo)) struct A [[bar]]",
+        })
+        {
+            cppdecl::Type type = cppdecl::ParseType_Simple(str);
+            cppdecl::FlatType flat(type);
+            if (flat.ToType() != type)
+                Fail("Flat type doesn't roundtrip: " + std::string(str));
+            if (ToCode(flat, {}) != ToCode(type, {}))
+                Fail("Wrong `ToCode()` of a flat type: " + std::string(str));
+
+            cppdecl::FlatType flat_copy = flat;
+            if (flat_copy != flat || flat_copy == cppdecl::FlatType{})
+                Fail("Wrong flat type comparison.");
+
+            // The cached values of the integer literals are restored too, since the comparison above ignores them.
+            (void)flat.ToType().VisitEachComponent<cppdecl::NumericLiteral>({}, [&](const cppdecl::NumericLiteral &lit)
+            {
+                if (auto i = std::get_if<cppdecl::NumericLiteral::Integer>(&lit.var); i && (!i->cached_value || i->cached_value != cppdecl::NumericLiteral::Integer::DecodeValue(i->base, i->value)))
+                    Fail("Flat type doesn't roundtrip the cached value of an integer literal: " + std::string(str));
+                return cppdecl::VisitResult{};
+            });
+        }
+
+        for (std::string_view str : {
+            "int (x)", // Ambiguous.
+            "void foo(int (x))", // Nested ambiguity.
+            "A::~A()",
+            "A::operator int &() const",
+            "bool A<int>::operator<<(int)",
+            "int operator\"\"_x(const char *)",
+            "void *operator new[](std::size_t)",
+        })
+        {
+            std::string_view input = str;
+            auto decl = std::get<cppdecl::MaybeAmbiguousDecl>(cppdecl::ParseDecl(input, cppdecl::ParseDeclFlags::accept_everything));
+            if (cppdecl::FlatDecl(decl).ToDecl() != decl)
+                Fail("Flat decl doesn't roundtrip: " + std::string(str));
+        }
+
+        // Visiting the nodes.
+        cppdecl::FlatType flat(cppdecl::ParseType_Simple("std::map<std::vector<int>, float>"));
+        std::string words;
+        (void)flat.VisitNodes(cppdecl::FlatNodeKind::name_word, [&](cppdecl::FlatNodeRef node)
+        {
+            words += node.String(0);
+            words += ' ';
+            return cppdecl::VisitResult{};
+        });
+        CheckActualEqualsExpected("Wrong flat tree traversal.", words, "std map std vector int float ");
+    }
+
+    { // Views.
+        std::string_view input = " ::std::map<int, std::vector<A<(1 > 2)>>>::iterator *";
+        auto name_result = cppdecl::ParseQualifiedNameView(input);
+        auto &name = std::get<cppdecl::QualifiedNameView>(name_result);
+        if (!name.force_global_scope || !name.WordsAre({"std", "map", "iterator"}) || name.parts[1].template_args != "<int, std::vector<A<(1 > 2)>>>")
+            Fail("Wrong qualified name view.");
+        CheckActualEqualsExpected("Wrong qualified name view.", name.text, "::std::map<int, std::vector<A<(1 > 2)>>>::iterator");
+        CheckActualEqualsExpected("Wrong unparsed part of a qualified name view.", input, "*");
+        CheckActualEqualsExpected("Wrong qualified name view materialization.", cppdecl::ToCode(std::get<cppdecl::QualifiedName>(name.ToQualifiedName()), {}), "::std::map<int, std::vector<A<(1>2)>>>::iterator");
+
+        // Stop before `::*`.
+        input = "A<B>::C::*";
+        name_result = cppdecl::ParseQualifiedNameView(input);
+        if (!std::get<cppdecl::QualifiedNameView>(name_result).WordsAre({"A", "C"}) || input != "::*")
+            Fail("Wrong qualified name view.");
+
+        // The unsupported syntax is left for the normal parser.
+        for (std::string_view str : {"A::operator+", "A::~A", "(anonymous namespace)::A", "A::template B<int>", "A<\"foo\"_x, R\"(>)\">"})
+        {
+            input = str;
+            if (!std::holds_alternative<cppdecl::ParseViewUnsupported>(cppdecl::ParseQualifiedNameView(input)) || input != str)
+                Fail("Expected the qualified name view to be unsupported: " + std::string(str));
+        }
+
+        // Simple types.
+        auto CheckSimpleTypeView = [](std::string_view str, std::string_view expected_text)
+        {
+            std::string_view view_input = str;
+            std::string_view normal_input = str;
+            auto view_result = cppdecl::ParseSimpleTypeView(view_input);
+            auto normal_result = cppdecl::ParseSimpleType(normal_input);
+            auto &view = std::get<cppdecl::SimpleTypeView>(view_result);
+            CheckActualEqualsExpected("Wrong simple type view text.", view.text, expected_text);
+            if (view_input != normal_input)
+                Fail("The simple type view consumed a wrong amount of input: " + std::string(str));
+            if (std::get<cppdecl::SimpleType>(view.ToSimpleType()) != std::get<cppdecl::SimpleType>(normal_result))
+                Fail("Wrong simple type view materialization: " + std::string(str));
+        };
+        CheckSimpleTypeView("const std::vector<int> &", "const std::vector<int>");
+        CheckSimpleTypeView("unsigned long const long int x", "unsigned long const long int");
+        CheckSimpleTypeView("struct A::B volatile", "struct A::B volatile");
+        CheckSimpleTypeView("unsigned", "unsigned");
+        CheckSimpleTypeView("std::size_t x", "std::size_t");
+        // Member pointers. The class name isn't a part of the type.
+        CheckSimpleTypeView("A::B::*x", "");
+        CheckSimpleTypeView("::A<int> :: *x", "");
+        CheckSimpleTypeView("int A::B::*x", "int");
+
+        input = "unsigned long long";
+        auto type_result = cppdecl::ParseSimpleTypeView(input);
+        auto &type = std::get<cppdecl::SimpleTypeView>(type_result);
+        if (!type.IsBuiltIn() || type.num_builtin_words != 2 || type.flags != cppdecl::SimpleTypeFlags::unsigned_)
+            Fail("Wrong built-in simple type view.");
+
+        for (std::string_view str : {"[[a]] int", "_Complex double", "auto", "const", "A::operator int", "const A::*x"})
+        {
+            input = str;
+            if (!std::holds_alternative<cppdecl::ParseViewUnsupported>(cppdecl::ParseSimpleTypeView(input)) || input != str)
+                Fail("Expected the simple type view to be unsupported: " + std::string(str));
+        }
+    }
+
+    { // String scanning.
+        // Those have vectorized paths, so check them against the naive implementations, on the inputs crossing the block boundaries.
+        static_assert(cppdecl::IdentifierRunLength("foo_$1 bar") == 6);
+        static_assert(cppdecl::WhitespaceRunLength(" \t\r\nx") == 4);
+        static_assert(cppdecl::FindAnyOf("abc<def>", "<>") == 3);
+
+        for (std::size_t len = 0; len < 40; len++)
+        {
+            for (char ch : {' ', '\n', 'a', 'Z', '_', '$', '7', '@', '[', '`', '{', '/', ':', '<', '\x7f', '\x80', '\xC2', '\xff'})
+            {
+                std::string str(len, ch);
+                for (std::size_t pos = 0; pos <= len; pos++)
+                {
+                    // The string is `len` copies of `ch`, with `x` at `pos` (if it's not past the end), and some junk after that.
+                    std::string s = str;
+                    if (pos < len)
+                        s[pos] = 'x';
+                    s += " (";
+
+                    std::size_t expected_ident = 0;
+                    while (expected_ident < s.size() && cppdecl::IsIdentifierChar(s[expected_ident]))
+                        expected_ident++;
+                    std::size_t expected_nonident = 0;
+                    while (expected_nonident < s.size() && !cppdecl::IsIdentifierChar(s[expected_nonident]))
+                        expected_nonident++;
+                    std::size_t expected_ws = 0;
+                    while (expected_ws < s.size() && cppdecl::IsWhitespace(s[expected_ws]))
+                        expected_ws++;
+
+                    if (cppdecl::IdentifierRunLength(s) != expected_ident)
+                        Fail("Wrong `IdentifierRunLength()` for `" + s + "`.");
+                    if (cppdecl::NonIdentifierRunLength(s) != expected_nonident)
+                        Fail("Wrong `NonIdentifierRunLength()` for `" + s + "`.");
+                    if (cppdecl::WhitespaceRunLength(s) != expected_ws)
+                        Fail("Wrong `WhitespaceRunLength()` for `" + s + "`.");
+                    if (cppdecl::FindAnyOf(s, "x(") != s.find_first_of("x("))
+                        Fail("Wrong `FindAnyOf()` for `" + s + "`.");
+                }
+            }
+        }
+    }
+
+
+    { // Keyword classification.
+        static_assert(cppdecl::ClassifyKeyword("unsigned").id == cppdecl::Keyword::unsigned_);
+        static_assert(cppdecl::IsTypeRelatedKeyword("__restrict__") && !cppdecl::IsTypeRelatedKeyword("restrict"));
+        static_assert(cppdecl::ClassifyKeyword("").id == cppdecl::Keyword::none);
+
+        // Every keyword must find itself, and the similar words must not find anything.
+        for (const cppdecl::KeywordInfo &info : cppdecl::detail::Keywords::list)
+        {
+            if (cppdecl::ClassifyKeyword(info.spelling).id != info.id)
+                Fail("Keyword `" + std::string(info.spelling) + "` isn't found.");
+
+            for (std::string word : {std::string(info.spelling) + "_", "_" + std::string(info.spelling), std::string(info.spelling.substr(1)), std::string(info.spelling.substr(0, info.spelling.size() - 1))})
+            {
+                if (cppdecl::ClassifyKeyword(word).id != cppdecl::Keyword::none)
+                    Fail("Word `" + word + "` shouldn't be a keyword.");
+            }
+        }
+    }
+
+
+    { // The fast path of `ParseType()` must give the same results as the general parser.
+        for (std::string_view input : {
+            "int", "unsigned long long", "const char *", "const char *const *volatile", "int &&", "const int &", "std::vector<int> *&",
+            "int>", "int *,", "int &)", "int & &", "int &*", "int &const", "int *const &const", // Junk at the end, and errors.
+            "int[3]", "int *[3]", "int (*)()", "int *x", "int &x", "int A::*", "int *A::*", "[[a]] int", "int [[a]] *", "int *__restrict", // The fallback.
+        })
+        {
+            std::string_view fast_input = input;
+            std::string_view slow_input = input;
+            auto fast = cppdecl::ParseType(fast_input);
+            auto slow = cppdecl::ParseType(slow_input, cppdecl::ParseTypeFlags::no_fast_path);
+
+            if (fast_input.data() != slow_input.data())
+                Fail("The fast path of `ParseType()` stopped at a different position for `" + std::string(input) + "`.");
+
+            if (fast.index() != slow.index())
+                Fail("The fast path of `ParseType()` disagrees about the errors for `" + std::string(input) + "`.");
+            else if (auto fast_type = std::get_if<cppdecl::Type>(&fast))
+                CheckActualEqualsExpected("The fast path of `ParseType()` gave a different result.", cppdecl::ToString(*fast_type, {}), cppdecl::ToString(std::get<cppdecl::Type>(slow), {}));
+            else
+                CheckActualEqualsExpected("The fast path of `ParseType()` gave a different error.", std::get<cppdecl::ParseError>(fast).message, std::get<cppdecl::ParseError>(slow).message);
+        }
+    }
+
+
+    { // Parsing the Itanium-mangled names.
+        // The expected results are what `abi::__cxa_demangle()` returns for those.
+        for (auto [mangled, demangled] : {
+            std::pair<std::string_view, std::string_view>
+            {"i", "int"},
+            {"PKc", "char const*"},
+            {"PVKi", "int const volatile*"},
+            {"A3_A4_i", "int [3][4]"},
+            {"A_PKc", "char const* []"},
+            {"PFPFivEPFvvEE", "int (*(*)(void (*)()))()"},
+            {"FvizE", "void (int, ...)"},
+            {"DoFvvE", "void () noexcept"},
+            {"M1AKFviRE", "void (A::*)(int) const &"},
+            {"Ss", "std::string"},
+            {"FvRKSsE", "void (std::string const&)"},
+            {"St4pairIPiS0_E", "std::pair<int*, int*>"},
+            {"St6vectorIM1XKFvvESaIS2_EE", "std::vector<void (X::*)() const, std::allocator<void (X::*)() const> >"},
+            {"NSt3__16vectorIiNS_9allocatorIiEEEE", "std::__1::vector<int, std::__1::allocator<int> >"},
+            {"N1A1BIiE1CIS1_EE", "A::B<int>::C<A::B<int> >"},
+            {"N12_GLOBAL__N_11AE", "(anonymous namespace)::A"},
+            {"N1AIJiLin5ELm6ELb1EEEE", "A<int, -5, 6ul, true>"},
+        })
+        {
+            std::string_view input = mangled;
+            auto result = cppdecl::ParseItaniumMangledType(input);
+            if (auto error = std::get_if<cppdecl::ParseError>(&result))
+                Fail("Unable to parse the mangled name `" + std::string(mangled) + "`: " + error->message);
+            else if (!input.empty())
+                Fail("Unparsed junk after the mangled name `" + std::string(mangled) + "`.");
+            else
+                CheckActualEqualsExpected("Wrong result of parsing a mangled name.", cppdecl::ToString(std::get<cppdecl::Type>(result), {}), cppdecl::ToString(cppdecl::ParseType_Simple(demangled), {}));
+        }
+
+        // The unsupported constructs should fail instead of producing garbage.
+        for (std::string_view mangled : {"Dn", "Z4mainEUlvE_", "N1AILc65EEE", "S_", "N1A", "PFvi", "4abc", "99a"})
+        {
+            std::string_view input = mangled;
+            if (!std::holds_alternative<cppdecl::ParseError>(cppdecl::ParseItaniumMangledType(input)))
+                Fail("Expected the mangled name `" + std::string(mangled) + "` to fail to parse.");
+        }
+
+        #if CPPDECL_NEED_DEMANGLER
+        // Compare with the demangler on the actual `typeid(...).name()`s.
+        cppdecl::Demangler demangler;
+        for (const std::type_info *type : {
+            &typeid(std::unordered_map<std::string, std::vector<std::string>>), &typeid(std::unordered_map<int, float>::iterator), &typeid(int std::pair<int, int>::*),
+            &typeid(bool (std::string::*)() const), &typeid(std::array<int, 42>), &typeid(const char *const *volatile), &typeid(int (&)[3][4]),
+        })
+        {
+            std::string_view input = type->name();
+            auto result = cppdecl::ParseItaniumMangledType(input);
+            if (!std::holds_alternative<cppdecl::Type>(result) || !input.empty())
+                Fail("Unable to parse the mangled name `" + std::string(type->name()) + "`.");
+            else
+                CheckActualEqualsExpected("The mangled name parser disagrees with the demangler.", cppdecl::ToString(std::get<cppdecl::Type>(result), {}), cppdecl::ToString(cppdecl::ParseType_Simple(demangler(type->name())), {}));
+        }
+        #endif
+    }
+
+
+    { // Parsing the MSVC-decorated names.
+        // Those are `typeid(...).raw_name()` and `typeid(...).name()` from MSVC, except that we replace `__int64` with `long long`.
+        for (auto [decorated, undecorated] : {
+            std::pair<std::string_view, std::string_view>
+            {".H", "int"},
+            {"._N", "bool"},
+            {".PAH", "int *"},
+            {".PEAH", "int * __ptr64"},
+            {".PEBD", "char const * __ptr64"},
+            {".QEBD", "char const * __ptr64 const"},
+            {".PEAPEAH", "int * __ptr64 * __ptr64"},
+            {".AEAH", "int & __ptr64"},
+            {".$$QEAH", "int && __ptr64"},
+            {".PEAY02H", "int (* __ptr64)[3]"},
+            {".$$BY112H", "int [2][3]"},
+            {".?AVtype_info@@", "class type_info"},
+            {".?AUA@@", "struct A"},
+            {".?ATU@@", "union U"},
+            {".?AW4E@@", "enum E"},
+            {".PEBVA@@", "class A const * __ptr64"},
+            {".?AVB@A@N@@", "class N::A::B"},
+            {".?AVA@?A0x12345678@@", "class `anonymous namespace'::A"},
+            {".?AV?$vector@HV?$allocator@H@std@@@std@@", "class std::vector<int,class std::allocator<int> >"},
+            {".?AV?$vector@_JV?$allocator@_J@std@@@std@@", "class std::vector<long long,class std::allocator<long long> >"},
+            {".?AV?$basic_string@DU?$char_traits@D@std@@V?$allocator@D@2@@std@@", "class std::basic_string<char,struct std::char_traits<char>,class std::allocator<char> >"},
+            {".?AV?$map@HNU?$less@H@std@@V?$allocator@U?$pair@$$CBHN@std@@@2@@std@@", "class std::map<int,double,struct std::less<int>,class std::allocator<struct std::pair<int const ,double> > >"},
+            {".?AV?$C@VA@N@@VB@2@@N@@", "class N::C<class N::A,class N::B>"},
+            {".?AV?$array@H$0CK@@std@@", "class std::array<int,42>"},
+            {".?AV?$X@$0?4@@", "class X<-5>"},
+            {".?AV?$X@$0A@@@", "class X<0>"},
+            {".?AV?$tuple@$$V@std@@", "class std::tuple<>"},
+        })
+        {
+            std::string_view input = decorated;
+            auto result = cppdecl::ParseMsvcDecoratedType(input);
+            if (auto error = std::get_if<cppdecl::ParseError>(&result))
+                Fail("Unable to parse the decorated name `" + std::string(decorated) + "`: " + error->message);
+            else if (!input.empty())
+                Fail("Unparsed junk after the decorated name `" + std::string(decorated) + "`.");
+            else
+                CheckActualEqualsExpected("Wrong result of parsing a decorated name.", cppdecl::ToString(std::get<cppdecl::Type>(result), {}), cppdecl::ToString(cppdecl::ParseType_Simple(undecorated), {}));
+        }
+
+        // The unsupported constructs should fail instead of producing garbage.
+        for (std::string_view decorated : {".P6AXXZ", ".?AV<lambda_1>@@", ".?AV?$X@$1?x@@3HA@@", ".?AVA@1@", ".?AVA", ".PEA"})
+        {
+            std::string_view input = decorated;
+            if (!std::holds_alternative<cppdecl::ParseError>(cppdecl::ParseMsvcDecoratedType(input)))
+                Fail("Expected the decorated name `" + std::string(decorated) + "` to fail to parse.");
+        }
+    }
+
+    { // Parsing limits and measuring.
+        auto CheckMeasure = [](std::string_view type, std::size_t num_nodes, std::size_t depth)
+        {
+            cppdecl::Measurement m = cppdecl::Measure(cppdecl::ParseType_Simple(type));
+            if (m.num_nodes != num_nodes || m.depth != depth || m.num_alternatives != 0)
+                Fail("Wrong measurement of `" + std::string(type) + "`: " + std::to_string(m.num_nodes) + " nodes, depth " + std::to_string(m.depth) + ", " + std::to_string(m.num_alternatives) + " alternatives.");
+        };
+        CheckMeasure("int", 2, 1); // The type and the name.
+        CheckMeasure("std::vector<int> *", 7, 3); // The type, two name parts, the pointer, the list, and the type `int` with its name.
+        CheckMeasure("int[42]", 5, 2); // The type, `int`, the array, the size expression, and its token.
+        CheckMeasure("void (*)(int, float)", 8, 2); // The type, `void`, the pointer, the function, and two types with their names.
+
+        if (cppdecl::Measure(cppdecl::ParseDecl_Simple("int(x)")).num_alternatives != 1)
+            Fail("Wrong number of measured alternatives.");
+
+        // Parses with `limits` and returns the error message, or an empty string on success.
+        auto ParseWithLimits = [](std::string_view input, cppdecl::ParseLimits limits) -> std::string
+        {
+            cppdecl::ParseContext context{.limits = limits};
+            auto result = cppdecl::ParseType(input, {}, context);
+            if (context.depth != 0)
+                Fail("The nesting depth wasn't reset after parsing.");
+            if (auto error = std::get_if<cppdecl::ParseError>(&result))
+                return error->message;
+            return "";
+        };
+
+        // The results from the parser never exceed the limits they were parsed with.
+        for (std::string_view type : {"std::vector<int> *", "A<B<C<D>>>", "void (*)(int, float)", "int[sizeof(A<int>)]"})
+        {
+            cppdecl::Measurement m = cppdecl::Measure(cppdecl::ParseType_Simple(type));
+            CheckActualEqualsExpected("", ParseWithLimits(type, {.max_depth = m.depth}), "");
+            CheckActualEqualsExpected("", ParseWithLimits(type, {.max_depth = m.depth - 1}), "Exceeded the maximum nesting depth.");
+            CheckActualEqualsExpected("", ParseWithLimits(type, {.max_nodes = m.num_nodes - 1}), "Exceeded the maximum number of nodes.");
+        }
+
+        CheckActualEqualsExpected("", ParseWithLimits("int *******", {.max_nodes = 5}), "Exceeded the maximum number of nodes.");
+        CheckActualEqualsExpected("", ParseWithLimits("A<int, int, int>", {.max_template_args = 3}), "");
+        CheckActualEqualsExpected("", ParseWithLimits("A<int, int, int, int>", {.max_template_args = 3}), "Exceeded the maximum number of template arguments.");
+        CheckActualEqualsExpected("", ParseWithLimits("int (*)(int)", {.max_alternatives = 2}), "");
+        CheckActualEqualsExpected("", ParseWithLimits("int ((((*))))(int)", {.max_alternatives = 2}), "Exceeded the maximum number of alternatives.");
+
+        // The limits apply to the nested template arguments too.
+        CheckActualEqualsExpected("", ParseWithLimits("A<B<int, int, int, int>>", {.max_template_args = 3}), "Exceeded the maximum number of template arguments.");
+        std::string deep = "int";
+        for (int i = 0; i < 1000; i++)
+            deep = "A<" + deep + ">";
+        CheckActualEqualsExpected("", ParseWithLimits(deep, {.max_depth = 100}), "Exceeded the maximum nesting depth.");
+
+        { // Nested ambiguous declarators. The number of interpretations grows exponentially, and the results of the nested declarations are reused
+            //   from the memo rather than parsed again, so the reuses must count towards the limits too.
+            std::string nested = "int(";
+            for (int i = 0; i < 24; i++)
+                nested += "x" + std::to_string(i) + (i + 1 < 24 ? "(" : "");
+            nested += std::string(24, ')');
+
+            auto ParseDeclWithLimits = [](std::string_view input, cppdecl::ParseLimits limits) -> std::string
+            {
+                cppdecl::ParseContext context{.limits = limits};
+                auto result = cppdecl::ParseDecl(input, cppdecl::ParseDeclFlags::accept_everything, context);
+                if (auto error = std::get_if<cppdecl::ParseError>(&result))
+                    return error->message;
+                return "";
+            };
+
+            CheckActualEqualsExpected("", ParseDeclWithLimits(nested, {.max_nodes = 10000, .max_alternatives = 4}), "Exceeded the maximum number of alternatives.");
+            CheckActualEqualsExpected("", ParseDeclWithLimits(nested, {.max_nodes = 10000}), "Exceeded the maximum number of nodes.");
+            CheckActualEqualsExpected("", ParseDeclWithLimits(nested, {.max_alternatives = 1000}), "Exceeded the maximum number of alternatives.");
+            CheckActualEqualsExpected("", ParseDeclWithLimits("int(x0(x1(x2)))", {.max_nodes = 10000, .max_alternatives = 100}), "");
+        }
+
+        { // The limits apply to each parse separately when the context is reused.
+            cppdecl::ParseContext context{.limits = {.max_nodes = 100}};
+            auto ParseReused = [&](std::string_view input) -> std::string
+            {
+                auto result = cppdecl::ParseType(input, {}, context);
+                if (auto error = std::get_if<cppdecl::ParseError>(&result))
+                    return error->message;
+                return "";
+            };
+
+            CheckActualEqualsExpected("", ParseReused("std::vector<int> *"), "");
+            const std::size_t num_nodes = context.num_nodes;
+            for (int i = 0; i < 50; i++)
+                CheckActualEqualsExpected("", ParseReused("std::vector<int> *"), "");
+            if (context.num_nodes != num_nodes)
+                Fail("Expected `num_nodes` to only count the last parse.");
+
+            // A failure doesn't affect the next parse.
+            CheckActualEqualsExpected("", ParseReused(deep), "Exceeded the maximum number of nodes.");
+            CheckActualEqualsExpected("", ParseReused("std::vector<int> *"), "");
+
+            // Same for the other entry points.
+            for (int i = 0; i < 50; i++)
+            {
+                std::string_view input = "std::vector<int> a, *b";
+                if (!std::holds_alternative<cppdecl::DeclList>(cppdecl::ParseDeclList(input, cppdecl::ParseDeclFlags::accept_all_named, context)))
+                    Fail("Unable to parse a declaration list with a reused context.");
+            }
+        }
+    }
+
+    { // Parser statistics.
+        cppdecl::ParseStats stats;
+        cppdecl::ParseContext context{.stats = &stats};
+        std::string_view input = "void (*)(int (x), A<1 + 2>)";
+        if (!std::holds_alternative<cppdecl::Type>(cppdecl::ParseType(input, {}, context)) || !input.empty())
+            Fail("Unable to parse the type for the parser statistics.");
+        // One `(` in the declarator gives two candidates, and one backup of the declaration.
+        // The parameter `int (x)` is also ambiguous, with a `(` of its own.
+        if (stats.candidates < 2 || stats.open_paren_backups != 2 || stats.decl_reentries < 2 || stats.pseudo_expr_fallbacks != 1 || stats.backtracks < 2 || stats.bytes_scanned < 11)
+            Fail("Wrong parser statistics.");
+    }
+
+    { // Reusing the temporary storage of the parser across calls.
+        cppdecl::ParseContext context;
+        const std::string_view type = "void (*)(int (x), A<1 + 2>)";
+        std::size_t num_pooled_vectors = 0;
+        for (int i = 0; i < 3; i++)
+        {
+            std::string_view input = type;
+            auto result = cppdecl::ParseType(input, {}, context);
+            if (!std::holds_alternative<cppdecl::Type>(result) || !input.empty() || std::get<cppdecl::Type>(result) != cppdecl::ParseType_Simple(type))
+                Fail("Wrong result when reusing the context.");
+
+            std::size_t n = context.scratch.declarator_stacks.vectors.size() + context.scratch.decl_candidates.vectors.size() + context.scratch.decl_memo_entries.vectors.size();
+            if (n == 0)
+                Fail("Expected the temporary vectors to be kept in the context.");
+            if (i > 0 && n != num_pooled_vectors)
+                Fail("Expected the temporary vectors to be reused.");
+            num_pooled_vectors = n;
+        }
+    }
+
+    { // Resolving the ambiguities with a type oracle.
+        std::unordered_set<cppdecl::QualifiedName> types = {cppdecl::ParseQualifiedName_Simple("y"), cppdecl::ParseQualifiedName_Simple("ns::T"), cppdecl::ParseQualifiedName_Simple("stat"), cppdecl::ParseQualifiedName_Simple("T")};
+        std::unordered_set<cppdecl::QualifiedName> nontypes = {cppdecl::ParseQualifiedName_Simple("z")};
+        cppdecl::FuncTypeOracle oracle([&](const cppdecl::QualifiedName &name) -> std::optional<bool>
+        {
+            if (types.contains(name))
+                return true;
+            if (nontypes.contains(name))
+                return false;
+            return {};
+        });
+
+        auto ParseWithOracle = [&](std::string_view input, cppdecl::ParseDeclFlags flags) -> std::string
+        {
+            cppdecl::ParseContext context{.type_oracle = &oracle};
+            auto result = cppdecl::ParseDecl(input, flags, context);
+            if (auto error = std::get_if<cppdecl::ParseError>(&result))
+                return std::string("error: ") + error->message;
+            if (!input.empty())
+                return "unparsed junk: " + std::string(input);
+            return cppdecl::ToString(std::get<cppdecl::MaybeAmbiguousDecl>(result), {});
+        };
+
+        // Without the oracle, `y` can be either the parameter name or its type.
+        CheckActualEqualsExpected("", cppdecl::ToString(cppdecl::ParseType_Simple("int(x(y))"), {}), "a function taking 1 parameter: [ambiguous, either [unnamed function taking 1 parameter: [unnamed of type `y`], returning `x`] or [`y` of type `x`]], returning `int`");
+        CheckActualEqualsExpected("", ParseWithOracle("int(x(y))", cppdecl::ParseDeclFlags::accept_unnamed), "unnamed function taking 1 parameter: [unnamed function taking 1 parameter: [unnamed of type `y`], returning `x`], returning `int`");
+        CheckActualEqualsExpected("", ParseWithOracle("int(x(z))", cppdecl::ParseDeclFlags::accept_unnamed), "unnamed function taking 1 parameter: [`z` of type `x`], returning `int`");
+        CheckActualEqualsExpected("", ParseWithOracle("int(x(ns::T))", cppdecl::ParseDeclFlags::accept_unnamed), "unnamed function taking 1 parameter: [unnamed function taking 1 parameter: [unnamed of type `ns`::`T`], returning `x`], returning `int`");
+
+        // At the top level.
+        CheckActualEqualsExpected("", ParseWithOracle("x(y)", cppdecl::ParseDeclFlags::accept_everything), "ambiguous, either [unnamed function taking 1 parameter: [unnamed of type `y`], returning `x`] or [`x`, a constructor taking 1 parameter: [unnamed of type `y`]]");
+        CheckActualEqualsExpected("", ParseWithOracle("z x", cppdecl::ParseDeclFlags::accept_everything), "error: Expected a parameter list here.");
+
+        // The declared names can be the same as the known types, if they can't be the type in that position.
+        for (std::string_view decl : {"int stat(const char *, struct stat *)", "struct stat stat", "void f(int y)", "T T", "y y", "void f(T T, y *y)"})
+            CheckActualEqualsExpected("", ParseWithOracle(decl, cppdecl::ParseDeclFlags::accept_everything), cppdecl::ToString(cppdecl::ParseDecl_Simple(decl, cppdecl::ParseDeclFlags::accept_everything), {}));
+        CheckActualEqualsExpected("", ParseWithOracle("struct stat stat", cppdecl::ParseDeclFlags::accept_everything), "`stat` of type `stat`, explicitly a struct");
+
+        // The keywords are never passed to the oracle, and the unknown names are handled as usual.
+        CheckActualEqualsExpected("", ParseWithOracle("int(x(int))", cppdecl::ParseDeclFlags::accept_unnamed), "unnamed function taking 1 parameter: [unnamed function taking 1 parameter: [unnamed of type `int`], returning `x`], returning `int`");
+        CheckActualEqualsExpected("", ParseWithOracle("int(x(w))", cppdecl::ParseDeclFlags::accept_unnamed), cppdecl::ToString(cppdecl::ParseDecl_Simple("int(x(w))", cppdecl::ParseDeclFlags::accept_unnamed), {}));
+
+        // `ParseType()` respects the oracle too, both with and without the fast path. This also applies to the template arguments.
+        auto ParseTypeWithOracle = [&](std::string_view input, cppdecl::ParseTypeFlags flags) -> std::string
+        {
+            cppdecl::ParseContext context{.type_oracle = &oracle};
+            auto result = cppdecl::ParseType(input, flags, context);
+            if (auto error = std::get_if<cppdecl::ParseError>(&result))
+                return std::string("error: ") + error->message;
+            return cppdecl::ToString(std::get<cppdecl::Type>(result), {}) + (input.empty() ? "" : ", unparsed junk: " + std::string(input));
+        };
+        for (std::string_view type : {"z *", "y *", "w *", "A<z>", "A<y>", "A<w>", "A<z *>", "const A<z> &"})
+            CheckActualEqualsExpected("", ParseTypeWithOracle(type, {}), ParseTypeWithOracle(type, cppdecl::ParseTypeFlags::no_fast_path));
+        CheckActualEqualsExpected("", ParseTypeWithOracle("A<z>", {}), "`A` with 1 template argument: [non-type: [`z`]]");
+        CheckActualEqualsExpected("", ParseTypeWithOracle("A<y>", {}), "`A` with 1 template argument: [possibly type: `y`]");
+        CheckActualEqualsExpected("", ParseTypeWithOracle("A<w>", {}), "`A` with 1 template argument: [possibly type: `w`]");
+    }
+
+    { // Lazy template arguments.
+        auto ParseLazy = [](std::string_view input) -> cppdecl::Type
+        {
+            cppdecl::ParseContext context{.lazy_template_args = true};
+            auto result = cppdecl::ParseType(input, {}, context);
+            if (auto error = std::get_if<cppdecl::ParseError>(&result))
+                Fail(std::string("Unexpected parse error: ") + error->message);
+            if (!input.empty())
+                Fail("Unparsed junk: " + std::string(input));
+            return std::get<cppdecl::Type>(result);
+        };
+
+        cppdecl::Type type = ParseLazy("const std::map<int, std::vector<float>> *");
+        const cppdecl::UnqualifiedName &part = type.simple_type.name.parts.at(1);
+        if (!part.template_args || !part.template_args->IsLazy() || !part.template_args->args.empty())
+            Fail("Expected the template arguments to be lazy.");
+        CheckActualEqualsExpected("", part.template_args->unparsed, "<int, std::vector<float>>");
+        CheckActualEqualsExpected("", cppdecl::ToCode(type, {}), "const std::map<int, std::vector<float>> *");
+
+        // Matching parses a copy.
+        if (!part.TemplateArgsMatch(cppdecl::Type::FromSingleWord("int"), cppdecl::ParseType_Simple("std::vector<float>")))
+            Fail("Expected the template arguments to match.");
+        if (!part.template_args->IsLazy())
+            Fail("Expected the template arguments to stay lazy.");
+
+        // Materializing gives the same result as the normal parsing.
+        if (auto error = cppdecl::MaterializeTemplateArgs(type); error.message)
+            Fail(std::string("Unexpected parse error: ") + error.message);
+        if (type != cppdecl::ParseType_Simple("const std::map<int, std::vector<float>> *"))
+            Fail("The materialized type doesn't match.");
+
+        // Character literals with encoding prefixes, and digit separators.
+        for (std::string_view literal_type : {"A<'>'>", "A<L'>'>", "A<u'>'>", "A<U'>'>", "A<u8'>'>", "A<1'000>", "A<0x1'f>", "A<B<'>'>, L'<'>"})
+        {
+            cppdecl::Type lazy = ParseLazy(literal_type);
+            if (auto error = cppdecl::MaterializeTemplateArgs(lazy); error.message)
+                Fail("Unable to materialize `" + std::string(literal_type) + "`: " + error.message);
+            CheckActualEqualsExpected(std::string(literal_type), cppdecl::ToString(lazy, {}), cppdecl::ToString(cppdecl::ParseType_Simple(literal_type), {}));
+        }
+
+        // The errors are only reported when materializing.
+        cppdecl::Type bad = ParseLazy("A<int int>");
+        if (!cppdecl::MaterializeTemplateArgs(bad).message || !bad.simple_type.name.parts.at(0).template_args->IsLazy())
+            Fail("Expected materializing to fail.");
+
+        // Unbalanced brackets are handled by the normal parser.
+        std::string_view input = "A<int";
+        cppdecl::ParseContext context{.lazy_template_args = true};
+        auto result = cppdecl::ParseType(input, {}, context);
+        if (!std::holds_alternative<cppdecl::ParseError>(result))
+            Fail("Expected a parse error.");
+
+        // Materializing can use the same context as the lazy parsing, then the same limits and oracle apply.
+        {
+            cppdecl::ParseContext limited_context{.limits = {.max_template_args = 3}, .lazy_template_args = true};
+            std::string_view limited_input = "A<B<int, int, int, int>>";
+            auto limited_result = cppdecl::ParseType(limited_input, {}, limited_context);
+            if (!std::holds_alternative<cppdecl::Type>(limited_result) || !limited_input.empty())
+                Fail("Expected the lazy parse to succeed.");
+            CheckActualEqualsExpected("", cppdecl::MaterializeTemplateArgs(std::get<cppdecl::Type>(limited_result), limited_context).message, "Exceeded the maximum number of template arguments.");
+
+            cppdecl::FuncTypeOracle oracle([](const cppdecl::QualifiedName &name) -> std::optional<bool>
+            {
+                if (name.AsSingleWord() == "z")
+                    return false;
+                return {};
+            });
+            cppdecl::ParseContext oracle_context{.type_oracle = &oracle, .lazy_template_args = true};
+            cppdecl::Type oracle_type = ParseLazy("A<B<z>>");
+            if (auto error = cppdecl::MaterializeTemplateArgs(oracle_type, oracle_context); error.message)
+                Fail(std::string("Unexpected parse error: ") + error.message);
+            // The nested lists aren't lazy even though the context is.
+            CheckActualEqualsExpected("", cppdecl::ToString(oracle_type, {}), "`A` with 1 template argument: [possibly type: `B` with 1 template argument: [non-type: [`z`]]]");
+        }
+
+        // Simplifying materializes the arguments.
+        cppdecl::Type str_type = ParseLazy("std::basic_string<char, std::char_traits<char>, std::allocator<char>>");
+        cppdecl::Simplify(cppdecl::SimplifyFlags::all, str_type);
+        CheckActualEqualsExpected("", cppdecl::ToCode(str_type, {}), "std::string");
+    }
+
+    { // Discarding attributes, or keeping them unparsed.
+        auto ParseWithAttrFlags = [](std::string_view input, cppdecl::ParseAttributeListFlags attr_flags) -> cppdecl::Decl
+        {
+            cppdecl::ParseContext context{.attribute_flags = attr_flags};
+            auto result = cppdecl::ParseDecl(input, cppdecl::ParseDeclFlags::accept_everything, context);
+            if (auto error = std::get_if<cppdecl::ParseError>(&result))
+                Fail(std::string("Unexpected parse error: ") + error->message);
+            if (!input.empty())
+                Fail("Unparsed junk: " + std::string(input));
+            return std::get<cppdecl::MaybeAmbiguousDecl>(result);
+        };
+
+        const std::string_view input = "[[nodiscard, gnu::foo(\"]]\", x<(1>2)>)]] __attribute__((a, b(\")\"))) long __attribute__ ( (c) ) long x";
+
+        cppdecl::Decl decl = ParseWithAttrFlags(input, cppdecl::ParseAttributeListFlags::discard);
+        if (!decl.type.simple_type.attrs.attrs.empty())
+            Fail("Expected the attributes to be discarded.");
+        CheckActualEqualsExpected("", cppdecl::ToCode(decl, {}), "long long x");
+
+        decl = ParseWithAttrFlags(input, cppdecl::ParseAttributeListFlags::keep_raw_text);
+        CheckActualEqualsExpected("", cppdecl::ToCode(decl, {}), "[[nodiscard, gnu::foo(\"]]\", x<(1>2)>)]] __attribute__((a, b(\")\"))) __attribute__ ( (c) ) long long x");
+        CheckActualEqualsExpected("", cppdecl::ToString(decl, {}), "`x` of type `long long`, with attributes [unparsed list `[[nodiscard, gnu::foo(\"]]\", x<(1>2)>)]]`, GNU-style unparsed list `__attribute__((a, b(\")\")))`, GNU-style unparsed list `__attribute__ ( (c) )`]");
+        CheckActualEqualsExpected("", cppdecl::ToString(decl.type.simple_type.attrs.attrs.at(2), cppdecl::ToStringFlags::debug), "{style=gnu,raw=`__attribute__ ( (c) )`}");
+
+        // The brackets in the prefixed character literals are skipped.
+        CheckActualEqualsExpected("", cppdecl::ToCode(ParseWithAttrFlags("[[a(L']', u8']')]] int x", cppdecl::ParseAttributeListFlags::discard), {}), "int x");
+
+        // Unbalanced brackets are handled by the normal parser.
+        for (std::string_view bad : {"[[a(]] int x", "[[a)]] int x", "__attribute__((a) int x"})
+        {
+            cppdecl::ParseContext context{.attribute_flags = cppdecl::ParseAttributeListFlags::discard};
+            auto result = cppdecl::ParseDecl(bad, cppdecl::ParseDeclFlags::accept_everything, context);
+            if (!std::holds_alternative<cppdecl::ParseError>(result))
+                Fail("Expected a parse error.");
+        }
+
+        // Discarding or keeping the raw text must accept and reject the same inputs as the normal mode.
+        // Summarizes a parse result: the error message if any, and the unparsed part of the input.
+        auto Summarize = [](const auto &result, std::string_view rest) -> std::string
+        {
+            auto error = std::get_if<cppdecl::ParseError>(&result);
+            return (error ? std::string("error: ") + error->message : "ok") + ", rest: `" + std::string(rest) + "`";
+        };
+        auto ParseTypeSummary = [&](std::string_view input, cppdecl::ParseAttributeListFlags attr_flags)
+        {
+            cppdecl::ParseContext context{.attribute_flags = attr_flags};
+            auto result = cppdecl::ParseType(input, {}, context);
+            return Summarize(result, input);
+        };
+        auto ParseDeclListSummary = [&](std::string_view input, cppdecl::ParseAttributeListFlags attr_flags)
+        {
+            cppdecl::ParseContext context{.attribute_flags = attr_flags};
+            auto result = cppdecl::ParseDeclList(input, cppdecl::ParseDeclFlags::accept_everything, context);
+            return Summarize(result, input);
+        };
+
+        { // This must remain a pseudo-expression, rather than becoming `int`.
+            std::string_view input = "A<[[x]] int>";
+            cppdecl::ParseContext context{.attribute_flags = cppdecl::ParseAttributeListFlags::discard};
+            auto result = cppdecl::ParseType(input, {}, context);
+            if (auto error = std::get_if<cppdecl::ParseError>(&result))
+                Fail(std::string("Unexpected parse error: ") + error->message);
+            CheckActualEqualsExpected("", cppdecl::ToString(std::get<cppdecl::Type>(result), {}), "`A` with 1 template argument: [non-type: [list [[list [[`x`]]]], `int`]]");
+        }
+
+        for (std::string_view input : {"[[x]] int", "void([[x]] int)", "void(int, [[x]] int)", "A<[[x]] int>", "A<void([[x]] int)>", "[[x]] int a", "void f([[x]] int a)", "int [[x]] a", "__attribute__((x)) int", "[[x]] int a, *", "[[x]] int a, *b"})
+        {
+            for (auto attr_flags : {cppdecl::ParseAttributeListFlags::discard, cppdecl::ParseAttributeListFlags::keep_raw_text})
+            {
+                CheckActualEqualsExpected(std::string(input), ParseTypeSummary(input, attr_flags), ParseTypeSummary(input, {}));
+                CheckActualEqualsExpected(std::string(input), ParseDeclListSummary(input, attr_flags), ParseDeclListSummary(input, {}));
+            }
+        }
+    }
+
+    { // Declarations of several entities at once.
+        auto ParseList = [](std::string_view input) -> cppdecl::DeclList
+        {
+            auto result = cppdecl::ParseDeclList(input, cppdecl::ParseDeclFlags::accept_all_named);
+            if (auto error = std::get_if<cppdecl::ParseError>(&result))
+                Fail(std::string("Unexpected parse error: ") + error->message);
+            if (!input.empty())
+                Fail("Unparsed junk: " + std::string(input));
+            return std::get<cppdecl::DeclList>(result);
+        };
+
+        auto ListToCode = [](const cppdecl::DeclList &list)
+        {
+            std::string ret;
+            for (std::size_t i = 0; i < list.decls.size(); i++)
+            {
+                if (i > 0)
+                    ret += " | ";
+                ret += cppdecl::ToCode(list.GetDecl(i), {});
+            }
+            return ret;
+        };
+
+        cppdecl::DeclList list = ParseList("[[maybe_unused]] const unsigned int a, *const b, c[3], (*d)(int x, int y), &e");
+        CheckActualEqualsExpected("", cppdecl::ToCode(list.simple_type, {}), "const [[maybe_unused]] unsigned int");
+        if (std::any_of(list.decls.begin(), list.decls.end(), [](const cppdecl::MaybeAmbiguousDecl &decl){return !decl.type.simple_type.IsEmpty();}))
+            Fail("Expected the decl-specifier-seq to be stored only once.");
+        CheckActualEqualsExpected("", ListToCode(list), "const [[maybe_unused]] unsigned int a | const [[maybe_unused]] unsigned int *const b | const [[maybe_unused]] unsigned int c[3] | const [[maybe_unused]] unsigned int (*d)(int x, int y) | const [[maybe_unused]] unsigned int &e");
+
+        // The declarators that change the type keep their own copy.
+        list = ParseList("auto a, f() -> int *, b __attribute__((foo))");
+        if (!list.decls[0].type.simple_type.IsEmpty() || list.decls[1].type.simple_type.IsEmpty() || list.decls[2].type.simple_type.IsEmpty())
+            Fail("Expected only the changed declarators to store the type.");
+        CheckActualEqualsExpected("", ListToCode(list), "auto a | auto f() -> int * | __attribute__((foo)) auto b");
+
+        // A single declaration works too.
+        list = ParseList("std::vector<int> v");
+        CheckActualEqualsExpected("", ListToCode(list), "std::vector<int> v");
+
+        // Stops at anything that can't continue the list.
+        std::string_view input = "int a, b; int c";
+        auto result = cppdecl::ParseDeclList(input, cppdecl::ParseDeclFlags::accept_all_named);
+        if (!std::holds_alternative<cppdecl::DeclList>(result) || std::get<cppdecl::DeclList>(result).decls.size() != 2 || input != "; int c")
+            Fail("Expected to stop at `;`.");
+
+        for (std::string_view bad : {"int a,", "int a, , b", "int a, int b", "int a, *"})
+        {
+            input = bad;
+            result = cppdecl::ParseDeclList(input, cppdecl::ParseDeclFlags::accept_all_named);
+            if (!std::holds_alternative<cppdecl::ParseError>(result))
+                Fail("Expected a parse error on `" + std::string(bad) + "`.");
+        }
+    }
 
     // Simple parsing functions:
 
@@ -2027,10 +2919,59 @@ int main()
     }
 
 
+    { // The non-throwing versions.
+        auto a = cppdecl::TryParseType_Simple("std::vector<int> *x");
+        auto *a_error = std::get_if<cppdecl::SimpleParseError>(&a);
+        if (!a_error || a_error->kind != cppdecl::SimpleParseError::Kind::unparsed_junk || a_error->position != 18)
+            Fail("Expected unparsed junk at position 18.");
+        else
+            CheckActualEqualsExpected("", a_error->ToString("std::vector<int> *x", "type"), "cppdecl: Unparsed junk in type `std::vector<int> *x` starting from position 18: `x`.");
+
+        auto b = cppdecl::TryParseDecl_Simple("std::vector<int");
+        auto *b_error = std::get_if<cppdecl::SimpleParseError>(&b);
+        if (!b_error || b_error->kind != cppdecl::SimpleParseError::Kind::parse_error || b_error->position != 11)
+            Fail("Expected a parse error at position 11.");
+        else
+            CheckActualEqualsExpected("", b_error->message, "Unterminated template argument list.");
+
+        auto c = cppdecl::TryParseQualifiedName_Simple("A::*");
+        auto *c_error = std::get_if<cppdecl::SimpleParseError>(&c);
+        if (!c_error || c_error->kind != cppdecl::SimpleParseError::Kind::member_pointer)
+            Fail("Expected a member pointer error.");
+
+        auto d = cppdecl::TryParseType_Simple("std::vector<int> *");
+        if (auto type = std::get_if<cppdecl::Type>(&d))
+            CheckActualEqualsExpected("", cppdecl::ToString(*type, {}), "a pointer to `std`::`vector` with 1 template argument: [possibly type: `int`]");
+        else
+            Fail("Expected this to parse.");
+    }
+
+
     // Simple parsing classes that memoize results:
 
     // Just poke them to make sure they instantiate correctly.
     (void)cppdecl::TypeParser{}("int");
     (void)cppdecl::DeclParser{}("int x");
     (void)cppdecl::QualifiedNameParser{}("A::B");
+
+    { // The failures are cached too.
+        cppdecl::TypeParser parser;
+        for (int i = 0; i < 2; i++)
+        {
+            const auto &result = parser.TryParse("std::vector<int");
+            auto *error = std::get_if<cppdecl::SimpleParseError>(&result);
+            if (!error || error->position != 11)
+                Fail("Expected a parse error at position 11.");
+
+            try
+            {
+                (void)parser("std::vector<int");
+                Fail("Expected this to throw.");
+            }
+            catch (std::runtime_error &e)
+            {
+                CheckActualEqualsExpected("", e.what(), "cppdecl: Parse error in type `std::vector<int` at position 11: Unterminated template argument list.");
+            }
+        }
+    }
 }